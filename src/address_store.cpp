@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "address_store.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <unordered_set>
+
+namespace libbitcoin {
+namespace node {
+
+bool address_store::key::operator==(const key& other) const
+{
+    return port == other.port && ip == other.ip;
+}
+
+size_t address_store::key_hash::operator()(const key& value) const
+{
+    // Mapped IPv4 addresses differ in the last word only.
+    uint64_t high, low;
+    std::memcpy(&high, value.ip.data(), sizeof(high));
+    std::memcpy(&low, value.ip.data() + sizeof(high), sizeof(low));
+
+    auto hash = (high * 0x9e3779b97f4a7c15ull) ^ low ^ (uint64_t(value.port) << 48);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+}
+
+address_store::address_store(size_t capacity)
+  : capacity_(std::max(capacity, size_t(1))), next_(0)
+{
+}
+
+// static
+address_store::key address_store::make_key(const address& host)
+{
+    return key{ host.ip(), host.port() };
+}
+
+size_t address_store::capacity() const
+{
+    return capacity_;
+}
+
+size_t address_store::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+    return slots_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool address_store::insert(const address& host)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+
+    if (hosts_.find(make_key(host)) != hosts_.end())
+        return false;
+
+    size_t slot_index;
+    if (slots_.size() < capacity_)
+    {
+        slot_index = slots_.size();
+        slots_.push_back(slot{ host, {} });
+    }
+    else
+    {
+        slot_index = next_;
+        next_ = (next_ + 1) % capacity_;
+        unindex(slot_index);
+        slots_[slot_index].host = host;
+    }
+
+    index(slot_index);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool address_store::contains(const address& host) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+    return hosts_.find(make_key(host)) != hosts_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t address_store::count(uint64_t services) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+
+    if (services == 0)
+        return slots_.size();
+
+    std::vector<size_t> scratch;
+    return matching(services, scratch).size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void address_store::fetch(uint64_t services, address::list& out) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+
+    std::vector<size_t> scratch;
+    for (const auto slot_index: matching(services, scratch))
+        out.push_back(slots_[slot_index].host);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool address_store::fetch_random(uint64_t services, address& out) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+
+    std::vector<size_t> scratch;
+    const auto& matches = matching(services, scratch);
+    if (matches.empty())
+        return false;
+
+    const auto pick = static_cast<size_t>(pseudo_random(0, matches.size() - 1));
+    out = slots_[matches[pick]].host;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void address_store::sample(uint64_t services, size_t limit, address::list& out) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+
+    std::vector<size_t> scratch;
+    const auto& matches = matching(services, scratch);
+    const auto count = matches.size();
+
+    if (count <= limit)
+    {
+        for (const auto slot_index: matches)
+            out.push_back(slots_[slot_index].host);
+
+        return;
+    }
+
+    // Floyd's selection of limit distinct positions among the matches.
+    std::unordered_set<size_t> chosen;
+
+    for (auto bound = count - limit; bound < count; ++bound)
+    {
+        auto pick = static_cast<size_t>(pseudo_random(0, bound));
+        if (!chosen.insert(pick).second)
+        {
+            pick = bound;
+            chosen.insert(pick);
+        }
+
+        out.push_back(slots_[matches[pick]].host);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// static
+// Position of bit among the set bits of services.
+size_t address_store::rank(uint64_t services, size_t bit)
+{
+    const auto below = services & ((uint64_t(1) << bit) - 1);
+    return std::bitset<service_bits>(below).count();
+}
+
+// Slot indexes of the hosts advertising all of services. One bit is its
+// list as it is, more bits are filtered from the shortest of their lists
+// into scratch.
+const std::vector<size_t>& address_store::matching(uint64_t services,
+    std::vector<size_t>& scratch) const
+{
+    if (services == 0)
+    {
+        scratch.resize(slots_.size());
+        for (size_t slot_index = 0; slot_index < slots_.size(); ++slot_index)
+            scratch[slot_index] = slot_index;
+
+        return scratch;
+    }
+
+    const std::vector<size_t>* shortest = nullptr;
+    for (size_t bit = 0; bit < service_bits; ++bit)
+        if (((services >> bit) & 1) != 0 &&
+            (shortest == nullptr || services_[bit].size() < shortest->size()))
+            shortest = &services_[bit];
+
+    if ((services & (services - 1)) == 0)
+        return *shortest;
+
+    for (const auto slot_index: *shortest)
+        if ((slots_[slot_index].host.services() & services) == services)
+            scratch.push_back(slot_index);
+
+    return scratch;
+}
+
+void address_store::index(size_t slot_index)
+{
+    auto& entry = slots_[slot_index];
+    const auto services = entry.host.services();
+
+    entry.positions.clear();
+    for (size_t bit = 0; bit < service_bits; ++bit)
+    {
+        if (((services >> bit) & 1) == 0)
+            continue;
+
+        auto& members = services_[bit];
+        entry.positions.push_back(members.size());
+        members.push_back(slot_index);
+    }
+
+    hosts_.emplace(make_key(entry.host), slot_index);
+}
+
+void address_store::unindex(size_t slot_index)
+{
+    const auto& entry = slots_[slot_index];
+    const auto services = entry.host.services();
+    hosts_.erase(make_key(entry.host));
+
+    // Swap the last of each list into the vacated position.
+    size_t set = 0;
+    for (size_t bit = 0; bit < service_bits; ++bit)
+    {
+        if (((services >> bit) & 1) == 0)
+            continue;
+
+        auto& members = services_[bit];
+        const auto position = entry.positions[set++];
+        const auto moved = members.back();
+        members[position] = moved;
+        auto& moved_entry = slots_[moved];
+        moved_entry.positions[rank(moved_entry.host.services(), bit)] = position;
+        members.pop_back();
+    }
+}
+
+} // namespace node
+} // namespace libbitcoin
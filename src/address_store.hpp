@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NODE_ADDRESS_STORE_HPP
+#define LIBBITCOIN_NODE_ADDRESS_STORE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace node {
+
+/**
+ * Bounded pool of peer addresses, thread safe.
+ *
+ * Hosts are unique by ip and port, found through a hash index, and the
+ * oldest is dropped when the pool is full. A second index lists the hosts
+ * advertising each service bit, so counting or picking the hosts which
+ * advertise some bits costs the hosts of the rarest of these bits rather
+ * than the pool size, and one bit alone is read off its list.
+ */
+class address_store
+{
+public:
+    typedef message::network_address address;
+
+    explicit address_store(size_t capacity);
+
+    size_t capacity() const;
+    size_t size() const;
+
+    /// Add host unless known, true if added.
+    bool insert(const address& host);
+    bool contains(const address& host) const;
+
+    /// Number of hosts advertising all of services.
+    size_t count(uint64_t services) const;
+
+    /// Append the hosts advertising all of services to out.
+    void fetch(uint64_t services, address::list& out) const;
+
+    /// A random host advertising all of services, false if none.
+    bool fetch_random(uint64_t services, address& out) const;
+
+    /// Append up to limit distinct random hosts advertising all of services.
+    void sample(uint64_t services, size_t limit, address::list& out) const;
+
+private:
+    struct key
+    {
+        message::ip_address ip;
+        uint16_t port;
+
+        bool operator==(const key& other) const;
+    };
+
+    struct key_hash
+    {
+        size_t operator()(const key& value) const;
+    };
+
+    struct slot
+    {
+        address host;
+        std::vector<size_t> positions;  // in the list of each of its bits
+    };
+
+    static const size_t service_bits = 64;
+
+    typedef std::unordered_map<key, size_t, key_hash> host_index;
+    typedef std::array<std::vector<size_t>, service_bits> services_index;
+
+    static key make_key(const address& host);
+    static size_t rank(uint64_t services, size_t bit);
+
+    // Require the lock.
+    const std::vector<size_t>& matching(uint64_t services, std::vector<size_t>& scratch) const;
+    void index(size_t slot_index);
+    void unindex(size_t slot_index);
+
+    const size_t capacity_;
+
+    // -------------------------------------------------------------------------
+    mutable upgrade_mutex mutex_;
+    std::vector<slot> slots_;   // ring once full, next_ is the oldest
+    size_t next_;
+    host_index hosts_;
+    services_index services_;   // slot indexes by service bit
+    // -------------------------------------------------------------------------
+};
+
+} // namespace node
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,327 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <set>
+#include <utility>
+
+#include <bitcoin/bitcoin/message/messages.hpp>
+#include <bitcoin/bitcoin/message/version.hpp>
+#include <bitcoin/bitcoin/utility/assert.hpp>
+#include <bitcoin/bitcoin/utility/container_sink.hpp>
+#include <bitcoin/bitcoin/utility/container_source.hpp>
+#include <bitcoin/bitcoin/utility/istream_reader.hpp>
+#include <bitcoin/bitcoin/utility/ostream_writer.hpp>
+
+#include "board_sketch.hpp"
+#include "span_reader.hpp"
+
+namespace libbitcoin {
+namespace message {
+
+static const size_t partitions = 3;
+static const size_t cell_size = sizeof(uint32_t) + hash_size + sizeof(uint64_t);
+
+static uint64_t read_8_bytes(const hash_digest& id, size_t offset)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(value); i++)
+        value |= static_cast<uint64_t>(id[offset + i]) << (8 * i);
+
+    return value;
+}
+
+// splitmix64 finalizer.
+static uint64_t mix(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+// id_sketch
+// ----------------------------------------------------------------------------
+
+id_sketch::id_sketch(size_t cells)
+  : cells_((cells + partitions - 1) / partitions * partitions, cell{ 0, null_hash, 0 })
+{
+}
+
+size_t id_sketch::cells() const
+{
+    return cells_.size();
+}
+
+void id_sketch::insert(const hash_digest& id)
+{
+    update(id, 1);
+}
+
+void id_sketch::subtract(const id_sketch& other)
+{
+    BITCOIN_ASSERT(cells_.size() == other.cells_.size());
+
+    for (size_t i = 0; i < cells_.size(); i++)
+    {
+        auto& value = cells_[i];
+        const auto& removed = other.cells_[i];
+
+        value.count -= removed.count;
+        value.check_sum ^= removed.check_sum;
+        for (size_t byte = 0; byte < hash_size; byte++)
+            value.id_sum[byte] ^= removed.id_sum[byte];
+    }
+}
+
+bool id_sketch::decode(hash_list& positive, hash_list& negative) const
+{
+    id_sketch rest(*this);
+    std::vector<size_t> pure;
+    std::set<hash_digest> peeled;
+
+    for (size_t i = 0; i < rest.cells_.size(); i++)
+        if (is_pure(rest.cells_[i]))
+            pure.push_back(i);
+
+    // Peel pure cells, removing an id may make other cells pure.
+    while (!pure.empty())
+    {
+        const auto value = rest.cells_[pure.back()];
+        pure.pop_back();
+
+        if (!is_pure(value))
+            continue;
+
+        // A crafted sketch can move an id back and forth between cells with
+        // opposite counts, a real difference peels each id once and holds
+        // fewer ids than cells.
+        if (peeled.size() == rest.cells_.size() || !peeled.insert(value.id_sum).second)
+            return false;
+
+        (value.count > 0 ? positive : negative).push_back(value.id_sum);
+        rest.update(value.id_sum, -value.count);
+
+        for (size_t partition = 0; partition < partitions; partition++)
+        {
+            const auto i = rest.position(value.id_sum, partition);
+            if (is_pure(rest.cells_[i]))
+                pure.push_back(i);
+        }
+    }
+
+    for (const auto& value : rest.cells_)
+        if (value.count != 0 || value.check_sum != 0 || value.id_sum != null_hash)
+            return false;
+
+    return true;
+}
+
+bool id_sketch::from_data(uint32_t version, reader& source)
+{
+    cells_.clear();
+
+    const auto count = source.read_size_little_endian();
+
+    // Guard against potential for arbitrary memory allocation.
+    if (count > max_cells || count % partitions != 0)
+        source.invalidate();
+    else
+        cells_.reserve(count);
+
+    for (size_t i = 0; i < count && source; i++)
+    {
+        cell value;
+        value.count = static_cast<int32_t>(source.read_4_bytes_little_endian());
+        value.id_sum = source.read_hash();
+        value.check_sum = source.read_8_bytes_little_endian();
+        cells_.push_back(value);
+    }
+
+    if (!source)
+        cells_.clear();
+
+    return source;
+}
+
+void id_sketch::to_data(uint32_t version, writer& sink) const
+{
+    sink.write_variable_little_endian(cells_.size());
+
+    for (const auto& value : cells_)
+    {
+        sink.write_4_bytes_little_endian(static_cast<uint32_t>(value.count));
+        sink.write_hash(value.id_sum);
+        sink.write_8_bytes_little_endian(value.check_sum);
+    }
+}
+
+size_t id_sketch::serialized_size(uint32_t version) const
+{
+    return variable_uint_size(cells_.size()) + cells_.size() * cell_size;
+}
+
+// static
+// Not linear in the id, so a sum of several ids does not pass for one.
+uint64_t id_sketch::checksum(const hash_digest& id)
+{
+    return mix(read_8_bytes(id, 24) ^ mix(read_8_bytes(id, 0)));
+}
+
+// static
+bool id_sketch::is_pure(const cell& value)
+{
+    return (value.count == 1 || value.count == -1) &&
+        value.check_sum == checksum(value.id_sum);
+}
+
+// Ids are hashes, their bytes are used as the cell hashes as they are.
+size_t id_sketch::position(const hash_digest& id, size_t partition) const
+{
+    const auto size = cells_.size() / partitions;
+    return partition * size + read_8_bytes(id, 8 * partition) % size;
+}
+
+void id_sketch::update(const hash_digest& id, int32_t delta)
+{
+    if (cells_.empty())
+        return;
+
+    const auto check = checksum(id);
+
+    for (size_t partition = 0; partition < partitions; partition++)
+    {
+        auto& value = cells_[position(id, partition)];
+        value.count += delta;
+        value.check_sum ^= check;
+        for (size_t byte = 0; byte < hash_size; byte++)
+            value.id_sum[byte] ^= id[byte];
+    }
+}
+
+// board_sketch
+// ----------------------------------------------------------------------------
+
+const std::string board_sketch::command = "boardsketch";
+const uint32_t board_sketch::version_minimum = version::level::minimum;
+const uint32_t board_sketch::version_maximum = version::level::maximum;
+
+board_sketch board_sketch::factory_from_data(uint32_t version, const data_chunk& data)
+{
+    board_sketch instance;
+    instance.from_data(version, data);
+    return instance;
+}
+
+board_sketch board_sketch::factory_from_data(uint32_t version, std::istream& stream)
+{
+    board_sketch instance;
+    instance.from_data(version, stream);
+    return instance;
+}
+
+board_sketch board_sketch::factory_from_data(uint32_t version, reader& source)
+{
+    board_sketch instance;
+    instance.from_data(version, source);
+    return instance;
+}
+
+board_sketch::board_sketch()
+  : requested_cells_(0), sketch_()
+{
+}
+
+board_sketch::board_sketch(uint32_t requested_cells, id_sketch&& sketch)
+  : requested_cells_(requested_cells), sketch_(std::move(sketch))
+{
+}
+
+uint32_t board_sketch::requested_cells() const
+{
+    return requested_cells_;
+}
+
+const id_sketch& board_sketch::sketch() const
+{
+    return sketch_;
+}
+
+void board_sketch::reset()
+{
+    requested_cells_ = 0;
+    sketch_ = id_sketch();
+}
+
+bool board_sketch::is_valid() const
+{
+    return requested_cells_ != 0 || sketch_.cells() != 0;
+}
+
+bool board_sketch::from_data(uint32_t version, const data_chunk& data)
+{
+    span_reader source(data);
+    return from_data(version, source);
+}
+
+bool board_sketch::from_data(uint32_t version, std::istream& stream)
+{
+    istream_reader source(stream);
+    return from_data(version, source);
+}
+
+bool board_sketch::from_data(uint32_t version, reader& source)
+{
+    reset();
+
+    requested_cells_ = source.read_4_bytes_little_endian();
+    sketch_.from_data(version, source);
+
+    if (!source)
+        reset();
+
+    return source;
+}
+
+data_chunk board_sketch::to_data(uint32_t version) const
+{
+    data_chunk data;
+    const auto size = serialized_size(version);
+    data.reserve(size);
+    data_sink ostream(data);
+    to_data(version, ostream);
+    ostream.flush();
+    BITCOIN_ASSERT(data.size() == size);
+    return data;
+}
+
+void board_sketch::to_data(uint32_t version, std::ostream& stream) const
+{
+    ostream_writer sink(stream);
+    to_data(version, sink);
+}
+
+void board_sketch::to_data(uint32_t version, writer& sink) const
+{
+    sink.write_4_bytes_little_endian(requested_cells_);
+    sketch_.to_data(version, sink);
+}
+
+size_t board_sketch::serialized_size(uint32_t version) const
+{
+    return sizeof(uint32_t) + sketch_.serialized_size(version);
+}
+
+} // namespace message
+} // namespace libbitcoin
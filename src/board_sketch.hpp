@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_MESSAGE_BOARD_SKETCH_HPP
+#define LIBBITCOIN_MESSAGE_BOARD_SKETCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <bitcoin/bitcoin/define.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+#include <bitcoin/bitcoin/utility/data.hpp>
+#include <bitcoin/bitcoin/utility/reader.hpp>
+#include <bitcoin/bitcoin/utility/writer.hpp>
+
+namespace libbitcoin {
+namespace message {
+
+/**
+ * Invertible Bloom lookup table over object ids.
+ *
+ * Each id is added to one cell in each of three partitions. Subtracting the
+ * sketch of another board leaves only the ids of the symmetric difference,
+ * which decode() recovers as long as the difference is well below the
+ * number of cells (about two thirds of it).
+ */
+class BC_API id_sketch
+{
+public:
+    /// Upper bound of cells, sketches from the wire are checked against it.
+    static const size_t max_cells = 3 * 16384;
+
+    /// Rounded up to a multiple of three.
+    explicit id_sketch(size_t cells=0);
+
+    size_t cells() const;
+
+    void insert(const hash_digest& id);
+    void subtract(const id_sketch& other);
+
+    /// Split the ids of a subtracted sketch by the side they came from,
+    /// false if the difference is too large to be decoded or the sketch is
+    /// inconsistent (an id peeled twice).
+    bool decode(hash_list& positive, hash_list& negative) const;
+
+    bool from_data(uint32_t version, reader& source);
+    void to_data(uint32_t version, writer& sink) const;
+    size_t serialized_size(uint32_t version) const;
+
+private:
+    struct cell
+    {
+        int32_t count;
+        hash_digest id_sum;
+        uint64_t check_sum;
+    };
+
+    static uint64_t checksum(const hash_digest& id);
+    static bool is_pure(const cell& value);
+
+    size_t position(const hash_digest& id, size_t partition) const;
+    void update(const hash_digest& id, int32_t delta);
+
+    std::vector<cell> cells_;
+};
+
+/**
+ * Sketch of the sender's board, sent by both sides when a pinboard channel
+ * starts. A receiver that can't decode the difference asks for a sketch
+ * with more cells (requested_cells) instead.
+ */
+class BC_API board_sketch
+{
+public:
+    typedef std::shared_ptr<board_sketch> ptr;
+    typedef std::shared_ptr<const board_sketch> const_ptr;
+
+    static board_sketch factory_from_data(uint32_t version, const data_chunk& data);
+    static board_sketch factory_from_data(uint32_t version, std::istream& stream);
+    static board_sketch factory_from_data(uint32_t version, reader& source);
+
+    board_sketch();
+    board_sketch(uint32_t requested_cells, id_sketch&& sketch);
+
+    uint32_t requested_cells() const;
+    const id_sketch& sketch() const;
+
+    bool from_data(uint32_t version, const data_chunk& data);
+    bool from_data(uint32_t version, std::istream& stream);
+    bool from_data(uint32_t version, reader& source);
+    data_chunk to_data(uint32_t version) const;
+    void to_data(uint32_t version, std::ostream& stream) const;
+    void to_data(uint32_t version, writer& sink) const;
+    bool is_valid() const;
+    void reset();
+    size_t serialized_size(uint32_t version) const;
+
+    static const std::string command;
+    static const uint32_t version_minimum;
+    static const uint32_t version_maximum;
+
+private:
+    uint32_t requested_cells_;
+    id_sketch sketch_;
+};
+
+} // namespace message
+
+typedef message::board_sketch::const_ptr board_sketch_const_ptr;
+
+} // namespace libbitcoin
+
+#endif
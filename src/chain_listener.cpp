@@ -15,6 +15,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <ctime>
 
 #include <bitcoin/bitcoin/log/source.hpp>
@@ -26,14 +28,32 @@ using namespace bc;
 using namespace bc::node;
 using namespace bc::message;
 
-chain_sync_state::chain_sync_state(message_broadcaster::ptr broadcaster, const bc::chain::lite_header& last_checkpoint)
+static const size_t max_orphans = 10000;
+static const auto max_orphan_age = chrono::minutes(10);
+
+// Objects live at most 24 h, about 576 Litecoin blocks.
+static const size_t snapshot_depth = 1000;
+
+// Enough for the snapshot and for a full headers response.
+static const size_t min_prune_horizon = 2000;
+
+chain_sync_state::chain_sync_state(message_broadcaster::ptr broadcaster, const bc::chain::lite_header& last_checkpoint,
+                                   const std::string& headers_file, size_t prune_horizon)
     : broadcaster_(broadcaster),
-      starting_height_(last_checkpoint.validation.height)
+      prune_horizon_(prune_horizon == 0 ? 0 : max(prune_horizon, min_prune_horizon)),
+      tip_subscriber_(make_shared<tip_subscriber>(threadpool_, "chain_tip")),
+      store_(chain::header_record(chain::header_record(last_checkpoint),
+                                  last_checkpoint.validation.height, 0)),
+      orphans_(max_orphans, max_orphan_age)
 {
-    //chain_.reserve(100000); // commented for testing purpose
-    chain_.resize(1);
-    chain_[0].insert(last_checkpoint.hash());
-    known_blocks_[last_checkpoint.hash()] = last_checkpoint;
+    if (!headers_file.empty())
+    {
+        file_.reset(new chain::header_file(headers_file));
+        load_headers();
+    }
+
+    publish_snapshot();
+
     LOG_INFO(LOG_CHAIN_LISTENER) << "chain_sync_state::chain_sync_state completed.";
 }
 
@@ -44,128 +64,191 @@ chain_sync_state::~chain_sync_state()
     // Critical Section.
     bc::shared_lock lock(mutex_);
 
-    for (size_t h = 0; h < chain_.size(); h++) {
-        for (const auto &header_hash : chain_[h])
-            LOG_INFO(LOG_CHAIN_LISTENER) << (h + starting_height_) << " " << bc::encode_base16(header_hash);
-    }
+    for (size_t h = store_.base_height(); h <= store_.top_height(); h++)
+        LOG_INFO(LOG_CHAIN_LISTENER) << h << " " << bc::encode_base16(store_.at(h)->hash());
+
+    for (const auto &record : store_.forks())
+        LOG_INFO(LOG_CHAIN_LISTENER) << record.height() << " " << bc::encode_base16(record.hash()) << " (fork)";
     ///////////////////////////////////////////////////////////////////////////
 }
 
-const set<hash_digest> chain_sync_state::get_last_known_block_hash() const
+bc::code chain_sync_state::connect(const chain::header_record& unlinked, const chain::header_record& parent)
 {
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section.
-    bc::shared_lock lock(mutex_);
-    for (size_t i = chain_.size() - 1; i >= 0; i--) {
-        set<hash_digest>::const_iterator iter = chain_[i].begin();
-        if (iter != chain_[i].end() && *iter != null_hash) {
-            return chain_[i];
-        }
-    }
+    const auto cached = contexts_.find(parent.hash());
+    const auto context = cached == contexts_.end() ?
+        chain::header_context::build(store_, parent) : cached->second;
 
-    // we should know at least last checkpoint. Let's consider this state as an error.
-    LOG_ERROR(LOG_CHAIN_LISTENER) << "No known block hashes. At least checkpoint block hash is required to sync.";
+    const auto ec = context.accept(unlinked);
+    if (ec)
+        return ec;
 
-    const set<hash_digest> empty_set;
-    return empty_set;
-    ///////////////////////////////////////////////////////////////////////////
+    // Copied, pushing may move the parent record.
+    const auto height = parent.height() + 1;
+    const auto work = parent.work();
+
+    if (cached != contexts_.end())
+        contexts_.erase(cached);
+
+    store_.push(chain::header_record(unlinked, height, work));
+    contexts_[unlinked.hash()] = context.next(unlinked);
+    return error::success;
 }
 
-const std::set<bc::hash_digest> chain_sync_state::get_known_block_hashes(size_t height) const
+// Connect the pooled descendants of parent, depth first, the order does not
+// matter as each child only needs its parent connected.
+size_t chain_sync_state::connect_orphans(const hash_digest& parent, hash_digest& latest)
 {
-    const set<hash_digest> empty_set;
-    if (height < starting_height_)
-    {
-        LOG_ERROR(LOG_CHAIN_LISTENER) << "Height " << height
-                                      << " is below our earliest checkpoint " << starting_height_;
-        return empty_set;
-    }
+    size_t count = 0;
+    vector<hash_digest> pending{ parent };
 
-    if (height - starting_height_ >= chain_.size())
+    while (!pending.empty() && orphans_.size() > 0)
     {
-        LOG_ERROR(LOG_CHAIN_LISTENER) << "Height " << height
-                                      << " is above our oldest known header " << starting_height_ + chain_.size() - 1;
-        return empty_set;
-    }
+        const auto id = pending.back();
+        pending.pop_back();
 
-    size_t idx = height - starting_height_;
+        for (const auto &child : orphans_.take_children(id))
+        {
+            // Looked up again, pushing may move the parent record.
+            const auto ec = connect(child, *store_.find(id));
+            if (ec)
+            {
+                LOG_WARNING(LOG_CHAIN_LISTENER) << "Orphan header with hash " << bc::encode_base16(child.hash())
+                                                << " rejected: " << ec.message();
+                continue;
+            }
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section.
-    bc::shared_lock lock(mutex_);
-    for (size_t i = idx; i >= 0; i--) {
-        set<hash_digest>::const_iterator iter = chain_[i].begin();
-        if (iter != chain_[i].end() && *iter != null_hash) {
-            return chain_[i];
+            pending.push_back(child.hash());
+            latest = child.hash();
+            count++;
         }
     }
 
-    // we should know at least last checkpoint. Let's consider this state as an error.
-    LOG_ERROR(LOG_CHAIN_LISTENER) << "No known block hashes. At least checkpoint block hash is required to sync.";
+    if (count > 0)
+        LOG_INFO(LOG_CHAIN_LISTENER) << "Connected " << count << " orphan headers.";
 
-    return empty_set;
-    ///////////////////////////////////////////////////////////////////////////
+    return count;
 }
 
-uint32_t chain_sync_state::get_latest_timestamp() const
+void chain_sync_state::load_headers()
 {
-    const set<hash_digest> top = get_last_known_block_hash();
+    const auto start = chrono::steady_clock::now();
 
-    uint32_t latest_timestamp = 0;
-    for (const auto &h : top)
+    if (!file_->open(store_.top()))
     {
-        if (h != null_hash)
-        {
-            const auto iter = known_blocks_.find(h);
-            if (iter->second.timestamp() > latest_timestamp)
-                latest_timestamp = iter->second.timestamp();
-        }
+        LOG_ERROR(LOG_CHAIN_LISTENER) << "Headers won't be stored across restarts.";
+        file_.reset();
+        return;
+    }
 
+    // Records are stored linked, the first one is the checkpoint. When
+    // pruning, only the records within the horizon are loaded.
+    size_t first = 1;
+    if (prune_horizon_ > 0 && file_->size() > prune_horizon_ + 1)
+    {
+        first = file_->size() - prune_horizon_;
+        store_.rebase(file_->at(first - 1));
     }
-    return latest_timestamp;
+
+    for (size_t position = first; position < file_->size(); position++)
+        store_.push(file_->at(position));
+
+    const auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+    LOG_INFO(LOG_CHAIN_LISTENER) << "Resumed at height " << store_.top_height() << " in " << elapsed.count() << " ms.";
 }
 
-size_t chain_sync_state::get_top_height() const
+void chain_sync_state::start()
 {
-    const set<hash_digest> top = get_last_known_block_hash();
+    threadpool_.join();
+    threadpool_.spawn(thread_default(1), thread_priority::normal);
+    tip_subscriber_->start();
+}
 
-    size_t max_height = 0;
-    for (const auto &h : top)
-    {
-        if (h != null_hash)
-        {
-            const auto iter = known_blocks_.find(h);
-            if (iter->second.validation.height > max_height)
-                max_height = iter->second.validation.height;
-        }
+void chain_sync_state::stop()
+{
+    tip_subscriber_->stop();
+    tip_subscriber_->invoke(error::service_stopped, null_hash, null_hash, 0);
+    threadpool_.shutdown();
+}
 
-    }
+void chain_sync_state::subscribe_tip(tip_handler&& handler)
+{
+    tip_subscriber_->subscribe(move(handler), error::service_stopped, null_hash, null_hash, 0);
+}
+
+set<hash_digest> chain_sync_state::hashes_at(size_t height) const
+{
+    set<hash_digest> hashes;
+
+    const auto main = store_.at(height);
+    if (main != nullptr)
+        hashes.insert(main->hash());
+
+    for (const auto &record : store_.forks())
+        if (record.height() == height)
+            hashes.insert(record.hash());
 
-    return max_height;
+    return hashes;
 }
 
-bc::config::checkpoint chain_sync_state::get_top_checkpoint() const
+hash_digest chain_sync_state::get_last_known_block_hash() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+    return store_.top().hash();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+const std::set<bc::hash_digest> chain_sync_state::get_known_block_hashes(size_t height) const
 {
-    const set<hash_digest> top = get_last_known_block_hash();
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
 
-    size_t max_height = 0;
-    hash_digest id_at_max_height = null_hash;
-    for (const auto &h : top)
+    if (height < store_.base_height())
     {
-        if (h != null_hash)
-        {
-            const auto iter = known_blocks_.find(h);
-            if (iter->second.validation.height > max_height)
-            {
-                max_height = iter->second.validation.height;
-                id_at_max_height = iter->second.hash();
-            }
-        }
+        LOG_ERROR(LOG_CHAIN_LISTENER) << "Height " << height
+                                      << " is below our earliest checkpoint " << store_.base_height();
+        return set<hash_digest>();
+    }
+
+    if (height > store_.top_height())
+    {
+        LOG_ERROR(LOG_CHAIN_LISTENER) << "Height " << height
+                                      << " is above our oldest known header " << store_.top_height();
+        return set<hash_digest>();
     }
 
-    config::checkpoint ch(id_at_max_height, max_height);
+    return hashes_at(height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+uint32_t chain_sync_state::get_latest_timestamp() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+    return store_.top().timestamp();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t chain_sync_state::get_top_height() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+    return store_.top_height();
+    ///////////////////////////////////////////////////////////////////////////
+}
 
-    return ch;
+bc::config::checkpoint chain_sync_state::get_top_checkpoint() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+    const auto &top = store_.top();
+    return config::checkpoint(top.hash(), top.height());
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 bc::code chain_sync_state::merge(headers_const_ptr message)
@@ -173,47 +256,102 @@ bc::code chain_sync_state::merge(headers_const_ptr message)
     LOG_INFO(LOG_CHAIN_LISTENER) << "-> chain_sync_state::merge";
 
     size_t count = 0;
+    bc::code result = error::success;
     hash_digest latest_header_id = null_hash;
+    const hash_digest old_tip = get_last_known_block_hash();
 
     for (const auto &h : message->elements())
     {
-        chain::lite_header lh(h);
+        // The header hash is computed here, once.
+        const chain::header_record unlinked(h);
+        const hash_digest& id = unlinked.hash();
 
-        bc::code ec = lh.check(true);
+        {
+            ///////////////////////////////////////////////////////////////////////////
+            // Critical Section.
+            bc::shared_lock lock(mutex_);
+
+            if (store_.find(id) != nullptr || orphans_.contains(id))
+            {
+                LOG_INFO(LOG_CHAIN_LISTENER) << "Header with hash " << bc::encode_base16(id) << " is already known";
+                continue;
+            }
+            ///////////////////////////////////////////////////////////////////////////
+        }
+
+        bc::code ec = unlinked.check(true);
         if (ec != error::success)
         {
-            LOG_WARNING(LOG_CHAIN_LISTENER) << "Bad PoW in header with hash " << bc::encode_base16(lh.hash());
-            return ec;
+            LOG_WARNING(LOG_CHAIN_LISTENER) << "Bad PoW in header with hash " << bc::encode_base16(id);
+            result = ec;
+            break;
         }
 
         ///////////////////////////////////////////////////////////////////////////
         // Critical Section.
         bc::unique_lock lock(mutex_);
 
-        if (known_blocks_.find(lh.hash()) != known_blocks_.end())
-        {
-            LOG_INFO(LOG_CHAIN_LISTENER) << "Header with hash " << bc::encode_base16(lh.hash()) << " is already known";
+        if (store_.find(id) != nullptr || orphans_.contains(id))
             continue;
-        }
 
-        hash_to_header_map::const_iterator iter = known_blocks_.find(lh.previous_block_hash());
-        if (known_blocks_.end() == iter)
+        const auto parent = store_.find(unlinked.previous_block_hash());
+        if (parent == nullptr)
         {
-            // TODO: add everything to orphan map
+            orphans_.add(unlinked);
         }
         else
         {
-            lh.validation.height = iter->second.validation.height + 1;
-            if (chain_.size() <= lh.validation.height)
-                chain_.resize(lh.validation.height - starting_height_ + 1);
-            known_blocks_[lh.hash()] = lh;
-            chain_[lh.validation.height - starting_height_].insert(lh.hash());
+            ec = connect(unlinked, *parent);
+            if (ec)
+            {
+                LOG_WARNING(LOG_CHAIN_LISTENER) << "Header with hash " << bc::encode_base16(id)
+                                                << " rejected: " << ec.message();
+                result = ec;
+                break;
+            }
+
             count++;
-            latest_header_id = lh.hash();
+            latest_header_id = id;
+            count += connect_orphans(id, latest_header_id);
         }
         ///////////////////////////////////////////////////////////////////////////
     }
 
+    if (count > 0)
+    {
+        hash_digest new_tip;
+        size_t depth;
+
+        {
+            ///////////////////////////////////////////////////////////////////////////
+            // Critical Section.
+            bc::unique_lock lock(mutex_);
+
+            if (file_ && !file_->sync(store_))
+                LOG_WARNING(LOG_CHAIN_LISTENER) << "Failed to store headers.";
+
+            new_tip = store_.top().hash();
+            depth = reorg_depth(old_tip);
+
+            if (prune_horizon_ > 0 && store_.prune(prune_horizon_) > 0)
+            {
+                for (auto it = contexts_.begin(); it != contexts_.end();)
+                {
+                    if (store_.find(it->first) == nullptr)
+                        it = contexts_.erase(it);
+                    else
+                        ++it;
+                }
+            }
+
+            publish_snapshot();
+            ///////////////////////////////////////////////////////////////////////////
+        }
+
+        if (new_tip != old_tip)
+            tip_subscriber_->relay(error::success, old_tip, new_tip, depth);
+    }
+
     if (count > 0)
     {
         inventory inv;
@@ -229,31 +367,134 @@ bc::code chain_sync_state::merge(headers_const_ptr message)
             });
     }
 
-    return error::success;
+    return result;
 }
 
-bool chain_sync_state::get_header_by_id(const hash_digest &id, chain::lite_header &header)
+bool chain_sync_state::get_header_by_id(const hash_digest &id, chain::header_record &header)
 {
     ///////////////////////////////////////////////////////////////////////////
     // Critical Section.
     bc::shared_lock lock(mutex_);
-    auto it = known_blocks_.find(id);
-    if (it == known_blocks_.end())
+    const auto record = store_.find(id);
+    if (record == nullptr)
         return false;
-    header = it->second;
+    header = *record;
     return true;
     ///////////////////////////////////////////////////////////////////////////
 }
 
+hash_list chain_sync_state::get_block_locator() const
+{
+    static const size_t dense_headers = 10;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+
+    const auto base = store_.base_height();
+    auto height = store_.top_height();
+    size_t step = 1;
+
+    hash_list locator;
+    while (true)
+    {
+        locator.push_back(store_.at(height)->hash());
+        if (height == base)
+            break;
+
+        if (locator.size() >= dense_headers)
+            step *= 2;
+
+        height = (height - base > step) ? height - step : base;
+    }
+
+    // Pruned history, newest first.
+    const auto &skeleton = store_.skeleton();
+    for (auto it = skeleton.rbegin(); it != skeleton.rend(); ++it)
+        locator.push_back(it->hash());
+
+    return locator;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool chain_sync_state::get_headers(const hash_list &locator, const hash_digest &stop, size_t limit,
+                                   message::serialized_headers &out) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+
+    size_t fork_height = 0;
+    if (!find_fork_height(locator, fork_height))
+        return false;
+
+    const auto first = fork_height + 1;
+    auto last = std::min(store_.top_height(), fork_height + limit);
+    for (auto height = first; height <= last; height++)
+    {
+        if (store_.at(height)->hash() == stop)
+        {
+            last = height;
+            break;
+        }
+    }
+
+    const auto count = first <= last ? last - first + 1 : 0;
+    out.data().reserve(count * chain::header_store::wire_size);
+    if (count > 0)
+        store_.copy_wire(first, count, out.data());
+
+    out.set_count(count);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+chain::chain_snapshot::ptr chain_sync_state::get_snapshot() const
+{
+    return atomic_load(&snapshot_);
+}
+
+void chain_sync_state::publish_snapshot()
+{
+    atomic_store(&snapshot_, chain::chain_snapshot::ptr(
+        make_shared<const chain::chain_snapshot>(store_, snapshot_depth)));
+}
+
+// Number of headers between old_tip and the main chain.
+size_t chain_sync_state::reorg_depth(const hash_digest &old_tip) const
+{
+    size_t depth = 0;
+
+    for (auto record = store_.find(old_tip); record != nullptr && !store_.is_main(record->hash());
+         record = store_.find(record->previous_block_hash()))
+        depth++;
+
+    return depth;
+}
+
+bool chain_sync_state::find_fork_height(const hash_list &locator, size_t &height) const
+{
+    for (const auto &id : locator)
+    {
+        if (store_.is_main(id))
+        {
+            height = store_.find(id)->height();
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool chain_sync_state::get_height_by_id(const bc::hash_digest &id, size_t &height)
 {
     ///////////////////////////////////////////////////////////////////////////
     // Critical Section.
     bc::shared_lock lock(mutex_);
-    auto it = known_blocks_.find(id);
-    if (it == known_blocks_.end())
+    const auto record = store_.find(id);
+    if (record == nullptr)
         return false;
-    height = it->second.validation.height;
+    height = record->height();
     return true;
     ///////////////////////////////////////////////////////////////////////////
 }
@@ -263,10 +504,10 @@ bool chain_sync_state::get_prev_hash_by_id(const bc::hash_digest &id, hash_diges
     ///////////////////////////////////////////////////////////////////////////
     // Critical Section.
     bc::shared_lock lock(mutex_);
-    auto it = known_blocks_.find(id);
-    if (it == known_blocks_.end())
+    const auto record = store_.find(id);
+    if (record == nullptr)
         return false;
-    prev_hash = it->second.previous_block_hash();
+    prev_hash = record->previous_block_hash();
     return true;
     ///////////////////////////////////////////////////////////////////////////
 }
@@ -277,29 +518,12 @@ bool chain_sync_state::is_synchronized() const
     // Critical Section.
     bc::shared_lock lock(mutex_);
 
-    if (chain_.size() == 0)
+    // The checkpoint alone does not count.
+    if (store_.top_height() == store_.base_height())
         return false;
 
-    uint32_t now = static_cast<uint32_t>(time(nullptr));
-
-    for (size_t pos = chain_.size() - 1; pos > 0; pos--)
-    {
-        if (!chain_[pos].empty())
-        {
-            for (const auto &id : chain_[pos])
-            {
-                const auto iter = known_blocks_.find(id);
-                if (iter != known_blocks_.end())
-                {
-                    if (now > iter->second.timestamp() && (now - 600) < iter->second.timestamp())
-                        return true;
-                }
-            }
-
-            return false;
-        }
-    }
-
-    return false;
+    const uint32_t now = static_cast<uint32_t>(time(nullptr));
+    const uint32_t timestamp = store_.top().timestamp();
+    return now > timestamp && (now - 600) < timestamp;
     ///////////////////////////////////////////////////////////////////////////
 }
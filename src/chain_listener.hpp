@@ -18,8 +18,11 @@
 #define CHAIN_LISTENER_HPP
 
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include <bitcoin/bitcoin.hpp>
@@ -28,8 +31,15 @@
 #include <bitcoin/bitcoin/message/messages.hpp>
 #include <bitcoin/bitcoin/config/checkpoint.hpp>
 
+#include "chain_snapshot.hpp"
+#include "header_context.hpp"
+#include "header_file.hpp"
+#include "header_record.hpp"
+#include "header_store.hpp"
 #include "lite_header.hpp"
 #include "message_broadcaster.hpp"
+#include "orphan_pool.hpp"
+#include "serialized_headers.hpp"
 
 #define LOG_CHAIN_LISTENER "chain_listener"
 
@@ -38,36 +48,89 @@ class chain_sync_state
 public:
     typedef std::shared_ptr<chain_sync_state> ptr;
 
-    typedef std::map<bc::hash_digest, bc::chain::lite_header> hash_to_header_map;
+    /// Called with the previous and the new top of the main chain and the
+    /// number of main chain headers disconnected by a reorganization.
+    /// Return false to unsubscribe.
+    typedef std::function<bool(const bc::code&, const bc::hash_digest& old_tip,
+                               const bc::hash_digest& new_tip, size_t reorg_depth)> tip_handler;
+    typedef bc::resubscriber<bc::code, bc::hash_digest, bc::hash_digest, size_t> tip_subscriber;
 
-    explicit chain_sync_state(bc::node::message_broadcaster::ptr broadcaster, const bc::chain::lite_header& last_checkpoint);
+    /// Headers are kept in headers_file across restarts unless it is empty.
+    /// With a non zero prune_horizon only headers of that many last heights
+    /// are kept in memory (at least 2000).
+    explicit chain_sync_state(bc::node::message_broadcaster::ptr broadcaster, const bc::chain::lite_header& last_checkpoint,
+                              const std::string& headers_file = std::string(), size_t prune_horizon = 0);
     virtual ~chain_sync_state();
 
+    /// Tip notifications are delivered between start and stop.
+    void start();
+    void stop();
+
+    /// Asynchronous notification of every change of the main chain top,
+    /// handlers get service_stopped when chain_sync_state stops.
+    void subscribe_tip(tip_handler&& handler);
+
     bc::code merge(bc::headers_const_ptr message);
 
-    bool try_to_connect_orphans() { return false; }
+    /// Latest published view of the chain top, lock free.
+    bc::chain::chain_snapshot::ptr get_snapshot() const;
 
-    const std::set<bc::hash_digest> get_last_known_block_hash() const;
+    /// Top of the main chain, the known branch with the most work.
+    bc::hash_digest get_last_known_block_hash() const;
     const std::set<bc::hash_digest> get_known_block_hashes(size_t height) const;
     uint32_t get_latest_timestamp() const;
     size_t get_top_height() const;
     bc::config::checkpoint get_top_checkpoint() const;
-    bool get_header_by_id(const bc::hash_digest &id, bc::chain::lite_header &header);
+    bool get_header_by_id(const bc::hash_digest &id, bc::chain::header_record &header);
+
+    /// Main chain hashes from the top back to the checkpoint, one per height
+    /// for the last 10 headers, then with exponentially growing steps.
+    bc::hash_list get_block_locator() const;
+
+    /// Main chain headers after the first locator hash we know, up to stop
+    /// or limit, false if no locator hash is on our main chain.
+    bool get_headers(const bc::hash_list &locator, const bc::hash_digest &stop, size_t limit,
+                     bc::message::serialized_headers &out) const;
     bool get_height_by_id(const bc::hash_digest &id, size_t &height);
     bool get_prev_hash_by_id(const bc::hash_digest &id, bc::hash_digest &prev_hash);
     bool is_synchronized() const;
 
 protected:
+    // Main chain entry and fork entries at height, requires the lock.
+    std::set<bc::hash_digest> hashes_at(size_t height) const;
+
+    void load_headers();
+
+    // Requires the lock.
+    bool find_fork_height(const bc::hash_list &locator, size_t &height) const;
+    size_t reorg_depth(const bc::hash_digest &old_tip) const;
+    void publish_snapshot();
+
+    // Requires the lock. Store unlinked on top of parent if it passes the
+    // contextual checks (bits and median time past).
+    bc::code connect(const bc::chain::header_record& unlinked, const bc::chain::header_record& parent);
+
+    // Requires the lock, returns the number of connected headers.
+    size_t connect_orphans(const bc::hash_digest& parent, bc::hash_digest& latest);
 
     bc::node::message_broadcaster::ptr broadcaster_;
+    const size_t prune_horizon_;
+
+    bc::threadpool threadpool_;
+    tip_subscriber::ptr tip_subscriber_;
 
     // -------------------------------------------------------------------------
     mutable bc::upgrade_mutex mutex_;
-    size_t starting_height_;
-    std::vector<std::set<bc::hash_digest>> chain_;
-    hash_to_header_map known_blocks_;
-    hash_to_header_map orphans_;
+    bc::chain::header_store store_;
+    std::unique_ptr<bc::chain::header_file> file_;
+    bc::chain::orphan_pool orphans_;
+
+    // Validation contexts of branch tips, others are rebuilt on demand.
+    std::map<bc::hash_digest, bc::chain::header_context> contexts_;
     // -------------------------------------------------------------------------
+
+    // Swapped with std::atomic_store, read with std::atomic_load.
+    bc::chain::chain_snapshot::ptr snapshot_;
 };
 
 #endif
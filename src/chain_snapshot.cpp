@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "chain_snapshot.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+chain_snapshot::chain_snapshot(const header_store& store, size_t depth)
+  : main_count_(0)
+{
+    const auto top = store.top_height();
+    const auto first = (top - store.base_height() > depth) ? top - depth : store.base_height();
+
+    anchors_.reserve(top - first + 1);
+
+    // The tip goes first.
+    for (auto height = top + 1; height > first; height--)
+        add(*store.at(height - 1));
+
+    main_count_ = anchors_.size();
+
+    for (const auto& record : store.forks())
+        if (record.height() >= first)
+            add(record);
+}
+
+const chain_snapshot::anchor& chain_snapshot::tip() const
+{
+    return anchors_.front();
+}
+
+const chain_snapshot::anchor* chain_snapshot::find(const hash_digest& hash) const
+{
+    const auto position = index_.find(hash);
+    return position == hash_index::not_found ? nullptr : &anchors_[position];
+}
+
+bool chain_snapshot::is_main(const hash_digest& hash) const
+{
+    const auto position = index_.find(hash);
+    return position != hash_index::not_found && position < main_count_;
+}
+
+// private
+void chain_snapshot::add(const header_record& record)
+{
+    index_.set(record.hash(), static_cast<uint32_t>(anchors_.size()));
+    anchors_.push_back(anchor{ record.hash(), static_cast<uint32_t>(record.height()), record.timestamp() });
+}
+
+} // namespace chain
+} // namespace libbitcoin
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CHAIN_CHAIN_SNAPSHOT_HPP
+#define LIBBITCOIN_CHAIN_CHAIN_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <bitcoin/bitcoin/math/hash.hpp>
+
+#include "header_store.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+/**
+ * Immutable view of the chain top published by chain_sync_state.
+ *
+ * Holds the tip and the headers of the last depth heights (main chain and
+ * forks) as (hash, height, timestamp), which is all objects need of their
+ * anchors. Readers share it through an atomically swapped pointer and never
+ * take the chain lock.
+ */
+class chain_snapshot
+{
+public:
+    typedef std::shared_ptr<const chain_snapshot> ptr;
+
+    struct anchor
+    {
+        hash_digest hash;
+        uint32_t height;
+        uint32_t timestamp;
+    };
+
+    /// Caller must keep store unchanged while the snapshot is built.
+    chain_snapshot(const header_store& store, size_t depth);
+
+    const anchor& tip() const;
+
+    /// Recent header with the given hash, nullptr if unknown or too old.
+    const anchor* find(const hash_digest& hash) const;
+
+    /// True if hash is a recent header of the main chain.
+    bool is_main(const hash_digest& hash) const;
+
+private:
+    void add(const header_record& record);
+
+    // Main chain anchors first.
+    std::vector<anchor> anchors_;
+    size_t main_count_;
+    hash_index index_;
+};
+
+} // namespace chain
+} // namespace libbitcoin
+
+#endif
@@ -19,6 +19,7 @@
 #define CONFIG_H
 
 #define PINBOARD_SERVICE_BIT 28
+#define PINBOARD_COMPRESSION_BIT 29
 #define MIN_TARGET ( (~bc::to_uint256(bc::null_hash)) / (bc::uint256_t(256) * 8) )
 
 #endif
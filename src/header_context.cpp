@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "header_context.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <bitcoin/bitcoin/chain/compact.hpp>
+#include <bitcoin/bitcoin/math/uint256.hpp>
+
+namespace libbitcoin {
+namespace chain {
+
+// Litecoin retargets every 2016 headers over 3.5 days (2.5 min spacing).
+static const size_t litecoin_retargeting_interval = 2016;
+static const int64_t litecoin_target_timespan = 302400;
+
+header_context::header_context()
+  : count_(0), position_(0), height_(0), bits_(0), period_start_(0)
+{
+    timestamps_.fill(0);
+}
+
+header_context::header_context(const header_record& record)
+  : count_(0), position_(0), height_(static_cast<uint32_t>(record.height())),
+    bits_(record.bits()), period_start_(0)
+{
+    timestamps_.fill(0);
+    add_timestamp(record.timestamp());
+}
+
+// static
+header_context header_context::build(const header_store& store,
+    const header_record& record)
+{
+    // Newest first, ends early at the checkpoint or the pruned base.
+    std::array<uint32_t, window_size> recent;
+    size_t known = 0;
+
+    for (auto ancestor = &record; ancestor != nullptr && known < window_size;
+        ancestor = store.find(ancestor->previous_block_hash()))
+        recent[known++] = ancestor->timestamp();
+
+    header_context context;
+    context.height_ = static_cast<uint32_t>(record.height());
+    context.bits_ = record.bits();
+
+    while (known > 0)
+        context.add_timestamp(recent[--known]);
+
+    // The retarget period starts after the header at period * interval - 1.
+    const auto period = record.height() / litecoin_retargeting_interval;
+    if (period == 0)
+        return context;
+
+    const auto start_height = period * litecoin_retargeting_interval - 1;
+
+    // Walk a fork down to the main chain, which is indexed by height.
+    auto ancestor = &record;
+    while (ancestor != nullptr && ancestor->height() > start_height &&
+        !store.is_main(ancestor->hash()))
+        ancestor = store.find(ancestor->previous_block_hash());
+
+    if (ancestor != nullptr && ancestor->height() > start_height)
+        ancestor = store.at(start_height);
+
+    if (ancestor != nullptr && ancestor->height() == start_height)
+        context.period_start_ = ancestor->timestamp();
+
+    return context;
+}
+
+bool header_context::is_valid() const
+{
+    return count_ > 0;
+}
+
+size_t header_context::height() const
+{
+    return height_;
+}
+
+uint32_t header_context::median_time_past() const
+{
+    if (count_ < window_size)
+        return 0;
+
+    auto sorted = timestamps_;
+    const auto middle = sorted.begin() + window_size / 2;
+    std::nth_element(sorted.begin(), middle, sorted.end());
+    return *middle;
+}
+
+// [CalculateNextWorkRequired]
+uint32_t header_context::work_required() const
+{
+    if (!is_retarget_height(height_ + 1))
+        return bits_;
+
+    if (period_start_ == 0)
+        return 0;
+
+    const auto last = timestamps_[(position_ + window_size - 1) % window_size];
+    static const int64_t minimum = litecoin_target_timespan / retargeting_factor;
+    static const int64_t maximum = litecoin_target_timespan * retargeting_factor;
+    const auto timespan = std::max(minimum, std::min(maximum,
+        static_cast<int64_t>(last) - static_cast<int64_t>(period_start_)));
+
+    static const uint256_t pow_limit(compact{ work_limit(true) });
+    uint256_t target(compact{ bits_ });
+
+    // Litecoin drops a bit first so the product fits in 256 bits.
+    const auto shift = msb(target) >= msb(pow_limit);
+    if (shift)
+        target >>= 1;
+
+    target *= static_cast<uint64_t>(timespan);
+    target /= static_cast<uint64_t>(litecoin_target_timespan);
+
+    if (shift)
+        target <<= 1;
+
+    return compact(std::min(target, pow_limit)).normal();
+}
+
+code header_context::accept(const header_record& child) const
+{
+    const auto required = work_required();
+    const auto median = median_time_past();
+
+    if (required != 0 && child.bits() != required)
+        return error::incorrect_proof_of_work;
+
+    else if (median != 0 && child.timestamp() <= median)
+        return error::timestamp_too_early;
+
+    else
+        return error::success;
+}
+
+header_context header_context::next(const header_record& child) const
+{
+    header_context context(*this);
+    context.height_ = height_ + 1;
+    context.bits_ = child.bits();
+
+    // The parent precedes the retarget period the child opens.
+    if (is_retarget_height(context.height_))
+        context.period_start_ = timestamps_[(position_ + window_size - 1) % window_size];
+
+    context.add_timestamp(child.timestamp());
+    return context;
+}
+
+// static
+bool header_context::is_retarget_height(size_t height)
+{
+    return height % litecoin_retargeting_interval == 0;
+}
+
+void header_context::add_timestamp(uint32_t timestamp)
+{
+    timestamps_[position_] = timestamp;
+    position_ = (position_ + 1) % window_size;
+    count_ = std::min<uint32_t>(count_ + 1, window_size);
+}
+
+} // namespace chain
+} // namespace libbitcoin
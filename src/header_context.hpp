@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CHAIN_HEADER_CONTEXT_HPP
+#define LIBBITCOIN_CHAIN_HEADER_CONTEXT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <bitcoin/bitcoin/constants.hpp>
+#include <bitcoin/bitcoin/error.hpp>
+
+#include "header_record.hpp"
+#include "header_store.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+/**
+ * Contextual validation state of the chain ending with a given header: the
+ * timestamps of the last 11 headers (median time past) and what the next
+ * Litecoin retarget needs (bits of the tip and timestamp of the header
+ * preceding its retarget period).
+ *
+ * A child context is derived from its parent in constant time, so only the
+ * context of each branch tip has to be kept. Near the checkpoint or the base
+ * of a pruned store part of the state is unknown and the corresponding rule
+ * is not checked until enough headers have been connected.
+ */
+class header_context
+{
+public:
+    /// An invalid context.
+    header_context();
+
+    /// Context of a chain known from record on only.
+    explicit header_context(const header_record& record);
+
+    /// Rebuild the context of a stored record from its ancestors, at most
+    /// 11 of them and the one preceding the retarget period.
+    static header_context build(const header_store& store, const header_record& record);
+
+    bool is_valid() const;
+    size_t height() const;
+
+    /// Zero while fewer than 11 timestamps are known.
+    uint32_t median_time_past() const;
+
+    /// Bits required of the next header, zero if not known.
+    uint32_t work_required() const;
+
+    /// Check bits and timestamp of the next header.
+    code accept(const header_record& child) const;
+
+    /// Context of the chain extended by child, call accept first.
+    header_context next(const header_record& child) const;
+
+private:
+    static const size_t window_size = median_time_past_interval;
+
+    static bool is_retarget_height(size_t height);
+
+    void add_timestamp(uint32_t timestamp);
+
+    std::array<uint32_t, window_size> timestamps_;
+    uint32_t count_;            // known timestamps, up to window_size
+    uint32_t position_;         // next slot of the ring
+    uint32_t height_;
+    uint32_t bits_;
+    uint32_t period_start_;     // zero if not known
+};
+
+} // namespace chain
+} // namespace libbitcoin
+
+#endif
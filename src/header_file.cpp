@@ -0,0 +1,310 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "header_file.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin/log/source.hpp>
+#include <bitcoin/bitcoin/utility/assert.hpp>
+
+#define LOG_HEADER_FILE "header_file"
+
+namespace libbitcoin {
+namespace chain {
+
+static const uint32_t file_magic = 0x53484250;     // "PBHS"
+static const uint32_t file_format = 1;
+static const size_t initial_capacity = 4096;
+
+// Records written by the last few syncs may be torn, each sync writes the
+// headers of one headers message at most.
+static const size_t tail_window = 4096;
+
+header_file::header_file(const std::string& path)
+  : path_(path), capacity_(0)
+{
+}
+
+header_file::~header_file()
+{
+    close();
+}
+
+bool header_file::open(const header_record& checkpoint)
+{
+    boost::system::error_code ec;
+    const auto exists = boost::filesystem::exists(path_, ec);
+
+    if (!exists || boost::filesystem::file_size(path_, ec) < index_size)
+        return create(checkpoint);
+
+    if (!map(0))
+        return false;
+
+    const auto index = get_index();
+    if (index->magic != file_magic || index->format != file_format
+        || index->record_size != sizeof(header_record)
+        || index->base_height != checkpoint.height()
+        || index->base_hash != checkpoint.hash() || capacity_ == 0)
+    {
+        LOG_WARNING(LOG_HEADER_FILE) << "Header file " << path_
+                                     << " does not match the checkpoint, starting over.";
+        return create(checkpoint);
+    }
+
+    recover();
+    LOG_INFO(LOG_HEADER_FILE) << "Header file " << path_ << " holds " << size() << " headers.";
+    return true;
+}
+
+void header_file::close()
+{
+    if (file_.is_open())
+        file_.close();
+
+    capacity_ = 0;
+}
+
+bool header_file::is_open() const
+{
+    return file_.is_open();
+}
+
+size_t header_file::size() const
+{
+    return is_open() ? static_cast<size_t>(get_index()->count) : 0;
+}
+
+const header_record& header_file::at(size_t position) const
+{
+    BITCOIN_ASSERT(position < size());
+    return records()[position];
+}
+
+bool header_file::sync(const header_store& store)
+{
+    if (!is_open())
+        return false;
+
+    // A pruned store starts above the file.
+    const size_t base = get_index()->base_height;
+    if (store.base_height() < base || store.base_height() > base + size() - 1)
+        return false;
+
+    // Find the highest record shared with the main chain of the store.
+    auto height = std::min(base + size() - 1, store.top_height());
+    while (height > store.base_height() && records()[height - base].hash() != store.at(height)->hash())
+        height--;
+
+    const auto count = store.top_height() - base + 1;
+    if (!reserve(count))
+        return false;
+
+    // Records first, the count last. Both go through the page cache, so the
+    // records are flushed before the index is touched.
+    const auto out = records();
+    for (auto h = height + 1; h <= store.top_height(); h++)
+        out[h - base] = *store.at(h);
+
+    const auto first = height + 1 - base;
+    if (!flush(index_size + first * sizeof(header_record), (count - first) * sizeof(header_record)))
+        return false;
+
+    commit(count);
+    return true;
+}
+
+// private
+bool header_file::create(const header_record& checkpoint)
+{
+    close();
+
+    {
+        std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            LOG_ERROR(LOG_HEADER_FILE) << "Can't create header file " << path_;
+            return false;
+        }
+    }
+
+    if (!map(initial_capacity))
+        return false;
+
+    std::memset(file_.data(), 0, index_size);
+
+    const auto index = get_index();
+    index->magic = file_magic;
+    index->format = file_format;
+    index->record_size = sizeof(header_record);
+    index->base_height = static_cast<uint32_t>(checkpoint.height());
+    index->base_hash = checkpoint.hash();
+
+    records()[0] = checkpoint;
+    flush(index_size, sizeof(header_record));
+    commit(1);
+
+    LOG_INFO(LOG_HEADER_FILE) << "Created header file " << path_;
+    return true;
+}
+
+// private
+// Maps the file, growing it to hold at least capacity records first.
+bool header_file::map(size_t capacity)
+{
+    if (file_.is_open())
+        file_.close();
+
+    boost::system::error_code ec;
+    const auto bytes = index_size + capacity * sizeof(header_record);
+    if (boost::filesystem::file_size(path_, ec) < bytes)
+        boost::filesystem::resize_file(path_, bytes, ec);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_HEADER_FILE) << "Can't resize header file " << path_ << ": " << ec.message();
+        return false;
+    }
+
+    boost::iostreams::mapped_file_params params(path_);
+    params.flags = boost::iostreams::mapped_file::readwrite;
+
+    try
+    {
+        file_.open(params);
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR(LOG_HEADER_FILE) << "Can't map header file " << path_ << ": " << ex.what();
+        capacity_ = 0;
+        return false;
+    }
+
+    capacity_ = (file_.size() - index_size) / sizeof(header_record);
+    return true;
+}
+
+// private
+bool header_file::reserve(size_t count)
+{
+    if (count <= capacity_)
+        return true;
+
+    return map(std::max(count, capacity_ * 2));
+}
+
+// private
+void header_file::recover()
+{
+    const auto index = get_index();
+    size_t count = static_cast<size_t>(index->count);
+
+    if (index->checksum != index_checksum() || count == 0 || count > capacity_)
+    {
+        // The count can't be trusted, follow the parent links instead.
+        LOG_WARNING(LOG_HEADER_FILE) << "Header file index is damaged, scanning " << path_;
+        count = 1;
+        while (count < capacity_ && is_linked(count))
+            count++;
+    }
+    else
+    {
+        const auto first = count > tail_window ? count - tail_window : 1;
+        for (auto position = first; position < count; position++)
+        {
+            if (!is_linked(position))
+            {
+                count = position;
+                break;
+            }
+        }
+    }
+
+    if (count != index->count)
+    {
+        LOG_WARNING(LOG_HEADER_FILE) << "Truncating torn tail of " << path_ << " at "
+                                     << count << " of " << index->count << " headers.";
+        commit(count);
+    }
+}
+
+// private
+bool header_file::is_linked(size_t position) const
+{
+    const auto& record = records()[position];
+    const auto& parent = records()[position - 1];
+
+    return record.height() == parent.height() + 1
+        && record.previous_block_hash() == parent.hash()
+        && bitcoin_hash(record.data()) == record.hash();
+}
+
+// private
+header_file::index* header_file::get_index() const
+{
+    return reinterpret_cast<index*>(file_.data());
+}
+
+// private
+header_record* header_file::records() const
+{
+    return reinterpret_cast<header_record*>(file_.data() + index_size);
+}
+
+// private
+hash_digest header_file::index_checksum() const
+{
+    const auto begin = reinterpret_cast<const uint8_t*>(file_.data());
+    return sha256_hash(data_slice(begin, begin + offsetof(index, checksum)));
+}
+
+// private
+void header_file::commit(size_t count)
+{
+    const auto index = get_index();
+    index->count = count;
+    index->checksum = index_checksum();
+    flush(0, index_size);
+}
+
+// private
+// Writes the pages holding bytes [offset, offset + size) of the file through.
+bool header_file::flush(size_t offset, size_t size) const
+{
+    if (size == 0)
+        return true;
+
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto begin = offset / page * page;
+
+    if (msync(file_.data() + begin, offset + size - begin, MS_SYNC) != 0)
+    {
+        LOG_ERROR(LOG_HEADER_FILE) << "Can't flush header file " << path_;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace chain
+} // namespace libbitcoin
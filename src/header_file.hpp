@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CHAIN_HEADER_FILE_HPP
+#define LIBBITCOIN_CHAIN_HEADER_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+
+#include "header_record.hpp"
+#include "header_store.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+/**
+ * Memory mapped, append only copy of the main chain of a header_store.
+ *
+ * The file starts with a small index (magic, format, record size, base
+ * height and hash, record count and a checksum of these fields) followed by
+ * header_record values as they are, the checkpoint first. Records are flushed
+ * to disk before the count is written. Should the count still point past
+ * records which never reached the disk, as after a failed flush, open()
+ * detects the torn tail by checking the hash, height and parent link of the
+ * last records and truncates it.
+ *
+ * Not thread safe, chain_sync_state calls it under its own lock.
+ */
+class header_file
+{
+public:
+    explicit header_file(const std::string& path);
+    ~header_file();
+
+    header_file(const header_file&) = delete;
+    header_file& operator=(const header_file&) = delete;
+
+    /// Map the file, creating or resetting it if it does not belong to the
+    /// chain starting at checkpoint. False if the file can't be mapped.
+    bool open(const header_record& checkpoint);
+    void close();
+
+    bool is_open() const;
+
+    /// Number of stored records, the checkpoint included.
+    size_t size() const;
+
+    /// Record at position (the checkpoint is at 0).
+    const header_record& at(size_t position) const;
+
+    /// Bring the file in line with the main chain of store, rewriting it
+    /// from the fork point after a reorganization. The store may be pruned
+    /// but its base must be in the file.
+    bool sync(const header_store& store);
+
+private:
+    struct index
+    {
+        uint32_t magic;
+        uint32_t format;
+        uint32_t record_size;
+        uint32_t base_height;
+        hash_digest base_hash;
+        uint64_t count;
+        hash_digest checksum;
+    };
+
+    static const size_t index_size = 128;
+
+    static_assert(sizeof(index) <= index_size, "header_file index too large");
+
+    bool create(const header_record& checkpoint);
+    bool map(size_t capacity);
+    bool reserve(size_t count);
+    void recover();
+    bool is_linked(size_t position) const;
+
+    index* get_index() const;
+    header_record* records() const;
+    hash_digest index_checksum() const;
+    void commit(size_t count);
+    bool flush(size_t offset, size_t size) const;
+
+    const std::string path_;
+    boost::iostreams::mapped_file file_;
+    size_t capacity_;
+};
+
+} // namespace chain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "header_record.hpp"
+
+#include <algorithm>
+#include <bitcoin/bitcoin/constants.hpp>
+
+namespace libbitcoin {
+namespace chain {
+
+// Offsets of the fields in the 80 byte wire header.
+static const size_t version_offset = 0;
+static const size_t previous_offset = 4;
+static const size_t merkle_offset = 36;
+static const size_t timestamp_offset = 68;
+static const size_t bits_offset = 72;
+static const size_t nonce_offset = 76;
+
+static void write_4_bytes(uint8_t* out, uint32_t value)
+{
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static hash_digest to_work_bytes(const uint256_t& value)
+{
+    hash_digest out;
+    uint256_t rest = value;
+
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        out[i] = static_cast<uint8_t>(rest & 0xff);
+        rest >>= 8;
+    }
+
+    return out;
+}
+
+static uint256_t from_work_bytes(const hash_digest& bytes)
+{
+    uint256_t value = 0;
+
+    for (size_t i = bytes.size(); i > 0; i--)
+    {
+        value <<= 8;
+        value |= bytes[i - 1];
+    }
+
+    return value;
+}
+
+static header_record::header_bytes to_header_bytes(uint32_t version,
+    const hash_digest& previous_block_hash, const hash_digest& merkle,
+    uint32_t timestamp, uint32_t bits, uint32_t nonce)
+{
+    header_record::header_bytes out;
+    write_4_bytes(&out[version_offset], version);
+    std::copy(previous_block_hash.begin(), previous_block_hash.end(), &out[previous_offset]);
+    std::copy(merkle.begin(), merkle.end(), &out[merkle_offset]);
+    write_4_bytes(&out[timestamp_offset], timestamp);
+    write_4_bytes(&out[bits_offset], bits);
+    write_4_bytes(&out[nonce_offset], nonce);
+    return out;
+}
+
+// Constructors.
+//-----------------------------------------------------------------------------
+
+header_record::header_record()
+  : hash_(null_hash), work_(null_hash), height_(0)
+{
+    data_.fill(0);
+}
+
+header_record::header_record(const header& other)
+  : data_(to_header_bytes(other.version(), other.previous_block_hash(),
+        other.merkle(), other.timestamp(), other.bits(), other.nonce())),
+    hash_(bitcoin_hash(data_)),
+    work_(null_hash),
+    height_(0)
+{
+}
+
+header_record::header_record(const lite_header& other)
+  : data_(to_header_bytes(other.version(), other.previous_block_hash(),
+        other.merkle(), other.timestamp(), other.bits(), other.nonce())),
+    hash_(bitcoin_hash(data_)),
+    work_(null_hash),
+    height_(static_cast<uint32_t>(other.validation.height))
+{
+}
+
+header_record::header_record(const header_record& unlinked, size_t height,
+    const uint256_t& parent_work)
+  : data_(unlinked.data_),
+    hash_(unlinked.hash_),
+    work_(to_work_bytes(parent_work + lite_header::proof(unlinked.bits()))),
+    height_(static_cast<uint32_t>(height))
+{
+}
+
+bool header_record::operator==(const header_record& other) const
+{
+    return (hash_ == other.hash_) && (height_ == other.height_);
+}
+
+bool header_record::operator!=(const header_record& other) const
+{
+    return !(*this == other);
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+bool header_record::is_valid() const
+{
+    return hash_ != null_hash;
+}
+
+const header_record::header_bytes& header_record::data() const
+{
+    return data_;
+}
+
+const hash_digest& header_record::hash() const
+{
+    return hash_;
+}
+
+size_t header_record::height() const
+{
+    return height_;
+}
+
+uint256_t header_record::work() const
+{
+    return from_work_bytes(work_);
+}
+
+uint32_t header_record::version() const
+{
+    return read_4_bytes(version_offset);
+}
+
+hash_digest header_record::previous_block_hash() const
+{
+    return read_hash(previous_offset);
+}
+
+hash_digest header_record::merkle() const
+{
+    return read_hash(merkle_offset);
+}
+
+uint32_t header_record::timestamp() const
+{
+    return read_4_bytes(timestamp_offset);
+}
+
+uint32_t header_record::bits() const
+{
+    return read_4_bytes(bits_offset);
+}
+
+uint32_t header_record::nonce() const
+{
+    return read_4_bytes(nonce_offset);
+}
+
+hash_digest header_record::pow_hash() const
+{
+    return scrypt<32>(data_, data_, 1024, 1, 1);
+}
+
+// private
+uint32_t header_record::read_4_bytes(size_t offset) const
+{
+    return static_cast<uint32_t>(data_[offset])
+        | (static_cast<uint32_t>(data_[offset + 1]) << 8)
+        | (static_cast<uint32_t>(data_[offset + 2]) << 16)
+        | (static_cast<uint32_t>(data_[offset + 3]) << 24);
+}
+
+// private
+hash_digest header_record::read_hash(size_t offset) const
+{
+    hash_digest out;
+    std::copy(&data_[offset], &data_[offset] + hash_size, out.begin());
+    return out;
+}
+
+// Conversion.
+//-----------------------------------------------------------------------------
+
+header header_record::to_header() const
+{
+    return header(version(), previous_block_hash(), merkle(), timestamp(),
+        bits(), nonce());
+}
+
+lite_header header_record::to_lite_header() const
+{
+    lite_header out(version(), previous_block_hash(), merkle(), timestamp(),
+        bits(), nonce());
+    out.validation.height = height_;
+    return out;
+}
+
+// Validation.
+//-----------------------------------------------------------------------------
+
+code header_record::check(bool retarget) const
+{
+    if (!lite_header::is_valid_proof_of_work(bits(), pow_hash(), retarget))
+        return error::invalid_proof_of_work;
+
+    else if (!lite_header::is_valid_timestamp(timestamp()))
+        return error::futuristic_timestamp;
+
+    else
+        return error::success;
+}
+
+} // namespace chain
+} // namespace libbitcoin
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CHAIN_HEADER_RECORD_HPP
+#define LIBBITCOIN_CHAIN_HEADER_RECORD_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <bitcoin/bitcoin/chain/header.hpp>
+#include <bitcoin/bitcoin/define.hpp>
+#include <bitcoin/bitcoin/error.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+
+#include "lite_header.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+/**
+ * Packed, immutable header as kept by chain_sync_state: the 80 wire bytes,
+ * the header hash, the height and the cumulative chain work up to and
+ * including this header.
+ *
+ * The hash is computed once, when the record is built from a header. There
+ * is no lock and no heap allocation, records are trivially copyable and can
+ * be stored in contiguous arrays or written to disk as they are.
+ */
+class BC_API header_record
+{
+public:
+    static const size_t header_size = 80;
+
+    typedef std::array<uint8_t, header_size> header_bytes;
+
+    // Constructors.
+    //-----------------------------------------------------------------------------
+
+    /// An invalid record.
+    header_record();
+
+    /// Unlinked record (zero height and work), hashes the header.
+    explicit header_record(const header& other);
+    explicit header_record(const lite_header& other);
+
+    /// Record linked on top of its parent.
+    header_record(const header_record& unlinked, size_t height,
+        const uint256_t& parent_work);
+
+    header_record(const header_record& other) = default;
+    header_record& operator=(const header_record& other) = default;
+
+    bool operator==(const header_record& other) const;
+    bool operator!=(const header_record& other) const;
+
+    // Properties.
+    //-----------------------------------------------------------------------------
+
+    bool is_valid() const;
+
+    const header_bytes& data() const;
+    const hash_digest& hash() const;
+    size_t height() const;
+
+    /// Cumulative work of the chain ending with this header.
+    uint256_t work() const;
+
+    uint32_t version() const;
+    hash_digest previous_block_hash() const;
+    hash_digest merkle() const;
+    uint32_t timestamp() const;
+    uint32_t bits() const;
+    uint32_t nonce() const;
+
+    /// Not cached, the record is immutable.
+    hash_digest pow_hash() const;
+
+    // Conversion.
+    //-----------------------------------------------------------------------------
+
+    header to_header() const;
+    lite_header to_lite_header() const;
+
+    // Validation.
+    //-----------------------------------------------------------------------------
+
+    code check(bool retarget=false) const;
+
+private:
+    uint32_t read_4_bytes(size_t offset) const;
+    hash_digest read_hash(size_t offset) const;
+
+    header_bytes data_;
+    hash_digest hash_;
+    hash_digest work_;      // little endian uint256_t
+    uint32_t height_;
+};
+
+static_assert(std::is_trivially_copyable<header_record>::value,
+              "header_record must stay trivially copyable");
+
+} // namespace chain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,400 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "header_store.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <bitcoin/bitcoin/utility/assert.hpp>
+
+namespace libbitcoin {
+namespace chain {
+
+static const size_t initial_slots = 1024;
+
+// Pruning moves the main chain array by at least this many records.
+static const size_t prune_batch = 1024;
+
+// Thinned by half when exceeded, which keeps the skeleton exponential.
+static const size_t max_skeleton = 64;
+
+// hash_index
+// ----------------------------------------------------------------------------
+
+hash_index::hash_index()
+  : slots_(initial_slots, slot{ null_hash, not_found }), size_(0)
+{
+}
+
+size_t hash_index::size() const
+{
+    return size_;
+}
+
+// static
+size_t hash_index::bucket(const hash_digest& key)
+{
+    // The low order bytes of a header hash are its random part.
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(value); i++)
+        value |= static_cast<uint64_t>(key[i]) << (8 * i);
+
+    return static_cast<size_t>(value);
+}
+
+size_t hash_index::locate(const hash_digest& key) const
+{
+    const auto mask = slots_.size() - 1;
+    auto i = bucket(key) & mask;
+
+    while (slots_[i].value != not_found && slots_[i].key != key)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+uint32_t hash_index::find(const hash_digest& key) const
+{
+    return slots_[locate(key)].value;
+}
+
+void hash_index::set(const hash_digest& key, uint32_t value)
+{
+    BITCOIN_ASSERT(value != not_found);
+
+    // Keep the load factor at or below one half.
+    if ((size_ + 1) * 2 > slots_.size())
+        grow();
+
+    const auto i = locate(key);
+    if (slots_[i].value == not_found)
+        size_++;
+
+    slots_[i].key = key;
+    slots_[i].value = value;
+}
+
+bool hash_index::erase(const hash_digest& key)
+{
+    const auto mask = slots_.size() - 1;
+    auto i = locate(key);
+
+    if (slots_[i].value == not_found)
+        return false;
+
+    slots_[i].value = not_found;
+    size_--;
+
+    // Backward shift deletion, no tombstones.
+    for (auto j = (i + 1) & mask; slots_[j].value != not_found; j = (j + 1) & mask)
+    {
+        const auto home = bucket(slots_[j].key) & mask;
+
+        // The entry stays if its home bucket lies cyclically in (i, j].
+        const auto stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays)
+            continue;
+
+        slots_[i] = slots_[j];
+        slots_[j].value = not_found;
+        i = j;
+    }
+
+    return true;
+}
+
+void hash_index::clear()
+{
+    slots_.assign(initial_slots, slot{ null_hash, not_found });
+    size_ = 0;
+}
+
+void hash_index::grow()
+{
+    std::vector<slot> old(slots_.size() * 2, slot{ null_hash, not_found });
+    std::swap(old, slots_);
+
+    const auto mask = slots_.size() - 1;
+    for (const auto& entry : old)
+    {
+        if (entry.value == not_found)
+            continue;
+
+        auto i = bucket(entry.key) & mask;
+        while (slots_[i].value != not_found)
+            i = (i + 1) & mask;
+
+        slots_[i] = entry;
+    }
+}
+
+// header_store
+// ----------------------------------------------------------------------------
+
+header_store::header_store(const header_record& checkpoint, size_t wire_capacity)
+  : wire_capacity_(wire_capacity), wire_base_(checkpoint.height())
+{
+    BITCOIN_ASSERT(checkpoint.height() < fork_flag);
+    connect(checkpoint);
+}
+
+size_t header_store::base_height() const
+{
+    return main_.front().height();
+}
+
+size_t header_store::top_height() const
+{
+    return main_.back().height();
+}
+
+const header_record& header_store::top() const
+{
+    return main_.back();
+}
+
+const header_record* header_store::at(size_t height) const
+{
+    if (height < base_height() || height > top_height())
+        return nullptr;
+
+    return &main_[height - base_height()];
+}
+
+const header_record* header_store::find(const hash_digest& hash) const
+{
+    const auto value = index_.find(hash);
+
+    if (value == hash_index::not_found)
+        return nullptr;
+
+    if ((value & fork_flag) != 0)
+        return &forks_[value & ~fork_flag];
+
+    return at(value);
+}
+
+bool header_store::is_main(const hash_digest& hash) const
+{
+    const auto value = index_.find(hash);
+    return value != hash_index::not_found && (value & fork_flag) == 0;
+}
+
+const std::vector<header_record>& header_store::forks() const
+{
+    return forks_;
+}
+
+header_store::push_result header_store::push(const header_record& record)
+{
+    BITCOIN_ASSERT(find(record.previous_block_hash()) != nullptr);
+
+    if (record.previous_block_hash() == top().hash())
+    {
+        connect(record);
+        return push_result::main;
+    }
+
+    add_fork(record);
+
+    if (record.work() <= top().work())
+        return push_result::fork;
+
+    reorganize(record);
+    return push_result::reorganized;
+}
+
+void header_store::add_fork(const header_record& record)
+{
+    index_.set(record.hash(), static_cast<uint32_t>(forks_.size()) | fork_flag);
+    forks_.push_back(record);
+}
+
+void header_store::remove_fork(size_t slot)
+{
+    index_.erase(forks_[slot].hash());
+
+    if (slot + 1 != forks_.size())
+    {
+        forks_[slot] = forks_.back();
+        index_.set(forks_[slot].hash(), static_cast<uint32_t>(slot) | fork_flag);
+    }
+
+    forks_.pop_back();
+}
+
+// Make the branch ending with tip (a fork record) the main chain.
+void header_store::reorganize(const header_record& tip)
+{
+    std::vector<header_record> branch;
+    branch.push_back(tip);
+
+    const header_record* parent = find(tip.previous_block_hash());
+    while (parent != nullptr && !is_main(parent->hash()))
+    {
+        branch.push_back(*parent);
+        parent = find(parent->previous_block_hash());
+    }
+
+    BITCOIN_ASSERT(parent != nullptr);
+    const auto fork_height = parent->height();
+
+    // Move the disconnected part of the main chain to the side table.
+    for (auto height = fork_height + 1; height <= top_height(); height++)
+        add_fork(main_[height - base_height()]);
+
+    main_.resize(fork_height - base_height() + 1);
+
+    if (fork_height < wire_base_)
+    {
+        wire_.clear();
+        wire_base_ = fork_height + 1;
+    }
+    else
+    {
+        wire_.resize((fork_height + 1 - wire_base_) * wire_size);
+    }
+
+    // Connect the branch, oldest first.
+    for (auto it = branch.rbegin(); it != branch.rend(); ++it)
+    {
+        remove_fork(index_.find(it->hash()) & ~fork_flag);
+        connect(*it);
+    }
+}
+
+// Append to the main chain and to the wire cache.
+void header_store::connect(const header_record& record)
+{
+    main_.push_back(record);
+    index_.set(record.hash(), static_cast<uint32_t>(record.height()));
+
+    const auto& data = record.data();
+    wire_.insert(wire_.end(), data.begin(), data.end());
+    wire_.push_back(0);
+
+    // Drop the oldest half once the cache holds twice the capacity.
+    const auto cached = wire_.size() / wire_size;
+    if (cached > 2 * wire_capacity_)
+        drop_wire(wire_base_ + cached - wire_capacity_);
+}
+
+const config::checkpoint::list& header_store::skeleton() const
+{
+    return skeleton_;
+}
+
+size_t header_store::prune(size_t horizon)
+{
+    const auto top = top_height();
+    const auto keep_from = (top + 1 > horizon) ? top + 1 - horizon : 0;
+
+    if (keep_from < base_height() + prune_batch)
+        return 0;
+
+    const auto dropped = keep_from - base_height();
+    add_skeleton(main_.front());
+
+    for (size_t position = 0; position < dropped; position++)
+        index_.erase(main_[position].hash());
+
+    main_.erase(main_.begin(), main_.begin() + dropped);
+    drop_wire(keep_from);
+
+    // Forks can't reorganize once their fork point is gone, drop them
+    // and then their descendants.
+    auto removed = true;
+    while (removed)
+    {
+        removed = false;
+        for (auto slot = forks_.size(); slot > 0; slot--)
+        {
+            if (find(forks_[slot - 1].previous_block_hash()) == nullptr)
+            {
+                remove_fork(slot - 1);
+                removed = true;
+            }
+        }
+    }
+
+    return dropped;
+}
+
+void header_store::rebase(const header_record& record)
+{
+    BITCOIN_ASSERT(record.height() > base_height());
+    add_skeleton(main_.front());
+
+    main_.clear();
+    forks_.clear();
+    index_.clear();
+    wire_.clear();
+    wire_base_ = record.height();
+
+    connect(record);
+}
+
+// private
+void header_store::add_skeleton(const header_record& record)
+{
+    skeleton_.emplace_back(record.hash(), record.height());
+
+    if (skeleton_.size() <= max_skeleton)
+        return;
+
+    // Keep the oldest entry (the checkpoint) and every other entry counting
+    // back from the newest one.
+    config::checkpoint::list thinned;
+    thinned.push_back(skeleton_.front());
+    for (size_t position = 1; position < skeleton_.size(); position++)
+        if ((skeleton_.size() - 1 - position) % 2 == 0)
+            thinned.push_back(skeleton_[position]);
+
+    skeleton_.swap(thinned);
+}
+
+// private
+void header_store::drop_wire(size_t height)
+{
+    if (height <= wire_base_)
+        return;
+
+    const auto dropped = std::min(height - wire_base_, wire_.size() / wire_size);
+    wire_.erase(wire_.begin(), wire_.begin() + dropped * wire_size);
+    wire_base_ += dropped;
+}
+
+void header_store::copy_wire(size_t height, size_t count, data_chunk& out) const
+{
+    BITCOIN_ASSERT(height >= base_height() && height + count <= top_height() + 1);
+
+    // Older headers are serialized from the records.
+    for (; count > 0 && height < wire_base_; height++, count--)
+    {
+        const auto& data = main_[height - base_height()].data();
+        out.insert(out.end(), data.begin(), data.end());
+        out.push_back(0);
+    }
+
+    if (count == 0)
+        return;
+
+    const auto begin = wire_.begin() + (height - wire_base_) * wire_size;
+    out.insert(out.end(), begin, begin + count * wire_size);
+}
+
+} // namespace chain
+} // namespace libbitcoin
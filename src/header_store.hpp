@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CHAIN_HEADER_STORE_HPP
+#define LIBBITCOIN_CHAIN_HEADER_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <bitcoin/bitcoin/config/checkpoint.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+#include <bitcoin/bitcoin/utility/data.hpp>
+
+#include "header_record.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+/**
+ * Open addressing (linear probing) map from header hash to a 32 bit value.
+ * Header hashes are uniformly distributed, so the first 8 bytes of the hash
+ * are used as the bucket hash as they are.
+ */
+class hash_index
+{
+public:
+    static const uint32_t not_found = 0xffffffff;
+
+    hash_index();
+
+    size_t size() const;
+
+    uint32_t find(const hash_digest& key) const;
+    void set(const hash_digest& key, uint32_t value);
+    bool erase(const hash_digest& key);
+    void clear();
+
+private:
+    struct slot
+    {
+        hash_digest key;
+        uint32_t value;     // not_found marks an empty slot
+    };
+
+    static size_t bucket(const hash_digest& key);
+    size_t locate(const hash_digest& key) const;
+    void grow();
+
+    std::vector<slot> slots_;
+    size_t size_;
+};
+
+/**
+ * Header storage of chain_sync_state, not thread safe.
+ *
+ * The main chain is a contiguous array of records indexed by height, forks
+ * live in a side table. Every known header is reachable by hash through
+ * hash_index, which points either to a main chain height or to a fork slot.
+ *
+ * The wire format of the most recent main chain headers (80 bytes and a
+ * zero transaction count, as in a headers message) is also kept back to
+ * back, so a headers response is mostly a single copy.
+ *
+ * When pruned, only the headers of the last heights are kept in full, older
+ * history is reduced to a sparse skeleton of (hash, height) checkpoints used
+ * to complete block locators.
+ */
+class header_store
+{
+public:
+    enum class push_result
+    {
+        main,           // extended the main chain
+        fork,           // stored in the side table
+        reorganized     // a fork became the main chain
+    };
+
+    /// Size of a header in a headers message.
+    static const size_t wire_size = header_record::header_size + 1;
+
+    /// The checkpoint is the first main chain record, the wire format of at
+    /// least wire_capacity recent main chain headers is cached.
+    explicit header_store(const header_record& checkpoint, size_t wire_capacity=4000);
+
+    size_t base_height() const;
+    size_t top_height() const;
+    const header_record& top() const;
+
+    /// Main chain record at height, nullptr if out of range.
+    const header_record* at(size_t height) const;
+
+    /// Main chain or fork record, nullptr if unknown.
+    const header_record* find(const hash_digest& hash) const;
+
+    bool is_main(const hash_digest& hash) const;
+
+    /// Append the wire format of count main chain headers from height on.
+    void copy_wire(size_t height, size_t count, data_chunk& out) const;
+
+    /// Main chain checkpoints below the base height, oldest first.
+    const config::checkpoint::list& skeleton() const;
+
+    /// Drop the records more than horizon heights below the top, together
+    /// with the forks rooted there. Compacts in batches, returns the number
+    /// of dropped main chain records.
+    size_t prune(size_t horizon);
+
+    /// Start over from record, a descendant of the main chain.
+    void rebase(const header_record& record);
+
+    /// Records of the side table.
+    const std::vector<header_record>& forks() const;
+
+    /// Store a record linked to a known parent (see header_record).
+    /// The branch with the greatest cumulative work becomes the main chain,
+    /// on equal work the first one seen stays.
+    push_result push(const header_record& record);
+
+private:
+    static const uint32_t fork_flag = 0x80000000;
+
+    void add_fork(const header_record& record);
+    void remove_fork(size_t slot);
+    void reorganize(const header_record& tip);
+    void connect(const header_record& record);
+    void add_skeleton(const header_record& record);
+    void drop_wire(size_t height);
+
+    std::vector<header_record> main_;
+    std::vector<header_record> forks_;
+    hash_index index_;
+
+    config::checkpoint::list skeleton_;
+
+    const size_t wire_capacity_;
+    size_t wire_base_;
+    data_chunk wire_;
+};
+
+} // namespace chain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "header_sync_scheduler.hpp"
+
+namespace libbitcoin {
+namespace node {
+
+header_sync_scheduler::header_sync_scheduler(const clock::duration& timeout)
+  : timeout_(timeout)
+{
+}
+
+bool header_sync_scheduler::acquire(const hash_digest& tip, const config::authority& peer)
+{
+    return assign(tip, peer, false);
+}
+
+bool header_sync_scheduler::take_over(const hash_digest& tip, const config::authority& peer)
+{
+    return assign(tip, peer, true);
+}
+
+void header_sync_scheduler::release(const config::authority& peer)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+
+    for (auto it = requests_.begin(); it != requests_.end();)
+    {
+        if (it->second.peer == peer)
+            it = requests_.erase(it);
+        else
+            ++it;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t header_sync_scheduler::in_flight() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+    return requests_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+bool header_sync_scheduler::assign(const hash_digest& tip, const config::authority& peer,
+                                   bool expired_only)
+{
+    const auto now = clock::now();
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+
+    const auto it = requests_.find(tip);
+    if (it == requests_.end())
+    {
+        if (expired_only)
+            return false;
+
+        requests_[tip] = request{ peer, now + timeout_ };
+        return true;
+    }
+
+    if (it->second.expiry > now)
+        return false;
+
+    it->second = request{ peer, now + timeout_ };
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace node
+} // namespace libbitcoin
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NODE_HEADER_SYNC_SCHEDULER_HPP
+#define LIBBITCOIN_NODE_HEADER_SYNC_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+#include <bitcoin/bitcoin/config/authority.hpp>
+
+namespace libbitcoin {
+namespace node {
+
+/**
+ * Node wide coordinator of get_headers requests, thread safe.
+ *
+ * Every channel runs its own protocol_lite_header_sync, but headers following
+ * a given tip are requested from one peer only (the leader of that tip).
+ * Other channels drop their duplicate requests and take over when the
+ * leader does not answer within the timeout.
+ */
+class header_sync_scheduler
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    explicit header_sync_scheduler(const clock::duration& timeout);
+
+    /// True if peer becomes the leader of tip and should send the request,
+    /// false if another peer has it in flight.
+    bool acquire(const hash_digest& tip, const config::authority& peer);
+
+    /// Like acquire, but only replaces a leader whose request has expired.
+    bool take_over(const hash_digest& tip, const config::authority& peer);
+
+    /// The peer answered or went away, none of its requests is in flight.
+    void release(const config::authority& peer);
+
+    size_t in_flight() const;
+
+private:
+    struct request
+    {
+        config::authority peer;
+        clock::time_point expiry;
+    };
+
+    bool assign(const hash_digest& tip, const config::authority& peer, bool expired_only);
+
+    const clock::duration timeout_;
+
+    // -------------------------------------------------------------------------
+    mutable upgrade_mutex mutex_;
+    std::map<hash_digest, request> requests_;
+    // -------------------------------------------------------------------------
+};
+
+} // namespace node
+} // namespace libbitcoin
+
+#endif
@@ -449,31 +449,64 @@ hash_digest lite_header::pow_hash() const
 
 /// BUGBUG: bitcoin 32bit unix time: en.wikipedia.org/wiki/Year_2038_problem
 bool lite_header::is_valid_timestamp() const
+{
+    return is_valid_timestamp(timestamp_);
+}
+
+// static
+bool lite_header::is_valid_timestamp(uint32_t timestamp)
 {
     using namespace std::chrono;
     static const auto two_hours = seconds(timestamp_future_seconds);
-    const auto time = wall_clock::from_time_t(timestamp_);
+    const auto time = wall_clock::from_time_t(timestamp);
     const auto future = wall_clock::now() + two_hours;
     return time <= future;
 }
 
-// [CheckProofOfWork]
 bool lite_header::is_valid_proof_of_work(bool retarget) const
 {
-    const auto bits = compact(bits_);
+    return is_valid_proof_of_work(bits_, pow_hash(), retarget);
+}
+
+// [CheckProofOfWork]
+// static
+bool lite_header::is_valid_proof_of_work(uint32_t bits, const hash_digest& pow_hash,
+    bool retarget)
+{
+    const auto compact_bits = compact(bits);
     static const uint256_t pow_limit(compact{ work_limit(retarget) });
 
-    if (bits.is_overflowed())
+    if (compact_bits.is_overflowed())
         return false;
 
-    uint256_t target(bits);
+    uint256_t target(compact_bits);
 
     // Ensure claimed work is within limits.
     if (target < 1 || target > pow_limit)
         return false;
 
     // Ensure actual work is at least claimed amount (smaller is more work).
-    return to_uint256(pow_hash()) <= target;
+    return to_uint256(pow_hash) <= target;
+}
+
+uint256_t lite_header::proof() const
+{
+    return proof(bits_);
+}
+
+// [GetBlockProof]
+// static
+uint256_t lite_header::proof(uint32_t bits)
+{
+    const auto compact_bits = compact(bits);
+
+    if (compact_bits.is_overflowed())
+        return 0;
+
+    uint256_t target(compact_bits);
+
+    // (2^256 - target - 1) / (target + 1) + 1 == 2^256 / (target + 1).
+    return (target == 0) ? 0 : (~target / (target + 1)) + 1;
 }
 
 // Validation.
@@ -143,6 +143,14 @@ public:
     bool is_valid_timestamp() const;
     bool is_valid_proof_of_work(bool retarget=true) const;
 
+    static bool is_valid_timestamp(uint32_t timestamp);
+    static bool is_valid_proof_of_work(uint32_t bits, const hash_digest& pow_hash,
+        bool retarget=true);
+
+    /// Work represented by the header's target, zero if bits are invalid.
+    uint256_t proof() const;
+    static uint256_t proof(uint32_t bits);
+
     code check(bool retarget=false) const;
     code accept(const chain_state& state) const;
 
@@ -16,6 +16,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -34,6 +36,29 @@ using namespace bc::config;
 using namespace bc::network;
 using namespace std::placeholders;
 
+// A get_headers request not answered within this time goes to another peer.
+static const auto header_request_timeout = std::chrono::seconds(20);
+
+// Same for get_objects, at most this many objects are asked from one peer.
+static const auto object_request_timeout = std::chrono::seconds(20);
+static const size_t max_objects_in_flight = 1000;
+
+// Announcements kept per peer and ids waiting for a request, over these
+// announcements are dropped.
+static const size_t max_objects_announced = 10000;
+static const size_t max_objects_pending = 100000;
+
+// Scores are kept for this many peers, the least recently seen is dropped.
+static const size_t max_scored_peers = 4096;
+
+// Outbound pinboard peers are the best scored of this many random ones,
+// except one in this many times a random peer is tried to explore.
+static const size_t peer_candidates = 8;
+static const size_t exploration_ratio = 5;
+
+// Answers to get_address share one sample for this long.
+static const auto address_sample_lifetime = std::chrono::seconds(60);
+
 lite_node::lite_node(const network::settings& network_settings,
                      chain_sync_state::ptr chain_state,
                      pinboard::ptr pinboard)
@@ -41,7 +66,11 @@ lite_node::lite_node(const network::settings& network_settings,
     peers_(std::max(network_settings.host_pool_capacity, 1u)),
     protocol_maximum_(network_settings.protocol_maximum),
     chain_state_(chain_state),
-    pinboard_(pinboard)
+    pinboard_(pinboard),
+    header_scheduler_(header_request_timeout),
+    object_tracker_(object_request_timeout, max_objects_in_flight, max_objects_announced,
+                    max_objects_pending),
+    scores_(max_scored_peers)
 {
 }
 
@@ -87,6 +116,75 @@ config::checkpoint lite_node::top_block() const
     return chain_state_->get_top_checkpoint();
 }
 
+header_sync_scheduler& lite_node::header_scheduler()
+{
+    return header_scheduler_;
+}
+
+object_request_tracker& lite_node::object_tracker()
+{
+    return object_tracker_;
+}
+
+peer_scores& lite_node::scores()
+{
+    return scores_;
+}
+
+send_queue::ptr lite_node::outbound(send_queue::channel_ptr channel)
+{
+    const auto nonce = channel->nonce();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    outbound_mutex_.lock_upgrade();
+
+    const auto it = outbound_.find(nonce);
+    if (it != outbound_.end())
+    {
+        const auto queue = it->second;
+        outbound_mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return queue;
+    }
+
+    outbound_mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    auto& queue = outbound_[nonce];
+    const auto created = !queue;
+    if (created)
+        queue = std::make_shared<send_queue>(channel);
+
+    const auto result = queue;
+    outbound_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (created)
+    {
+        channel->subscribe_stop([this, nonce](const code&)
+        {
+            send_queue::ptr queue;
+
+            ///////////////////////////////////////////////////////////////////
+            // Critical Section.
+            outbound_mutex_.lock();
+            const auto it = outbound_.find(nonce);
+            if (it != outbound_.end())
+            {
+                queue = it->second;
+                outbound_.erase(it);
+            }
+            outbound_mutex_.unlock();
+            ///////////////////////////////////////////////////////////////////
+
+            if (queue)
+                queue->stop();
+        });
+    }
+
+    return result;
+}
+
 void lite_node::handle_running(const code& ec, result_handler handler)
 {
     if (stopped())
@@ -116,41 +214,34 @@ size_t lite_node::connection_count(uint64_t services) const
 
 size_t lite_node::address_count(uint64_t services) const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(peers_mutex_);
+    return peers_.count(services);
+}
 
-    size_t count = 0;
-    for (const auto& addr : peers_)
-    {
-        if ((addr.services() & services) == services)
-            count++;
-    }
+address_const_ptr lite_node::sample_pinboard_addresses()
+{
+    const auto now = std::chrono::steady_clock::now();
 
-    return count;
     ///////////////////////////////////////////////////////////////////////////
-}
+    // Critical Section.
+    unique_lock lock(address_sample_mutex_);
 
-boost::circular_buffer<message::network_address>::const_iterator find(const boost::circular_buffer<message::network_address> &list, const message::network_address& host)
-{
-    const auto found = [&host](const message::network_address& entry)
-    {
-        return entry.port() == host.port() && entry.ip() == host.ip();
-    };
+    if (address_sample_ && now < address_sample_expiry_)
+        return address_sample_;
+
+    address::list sample;
+    sample.reserve(max_address - 1);
+    peers_.sample(1u << PINBOARD_SERVICE_BIT, max_address - 1, sample);
 
-    return std::find_if(list.begin(), list.end(), found);
+    address_sample_ = std::make_shared<const message::address>(std::move(sample));
+    address_sample_expiry_ = now + address_sample_lifetime;
+    return address_sample_;
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 void lite_node::store(const address::list& addresses, result_handler handler)
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    peers_mutex_.lock_upgrade();
-
     if (stopped_)
     {
-        peers_mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
         handler(error::service_stopped);
         return;
     }
@@ -168,9 +259,6 @@ void lite_node::store(const address::list& addresses, result_handler handler)
     const auto step = std::max(usable / accept, size_t(1));
     size_t accepted = 0;
 
-    peers_mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
     for (size_t index = 0; index < usable; index = ceiling_add(index, step))
     {
         const auto& host = addresses[index];
@@ -184,16 +272,10 @@ void lite_node::store(const address::list& addresses, result_handler handler)
         }
 
         // Do not allow duplicates in the host cache.
-        if (find(peers_, host) == peers_.end())
-        {
+        if (peers_.insert(host))
             ++accepted;
-            peers_.push_back(host);
-        }
     }
 
-    peers_mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
-
     LOG_DEBUG(LOG_NETWORK)
         << "Accepted (" << accepted << " of " << addresses.size()
         << ") host addresses: "
@@ -211,53 +293,49 @@ code lite_node::fetch_address(address& out_address) const
                 && (dice + connection_count(bc::message::version::service::node_network))
                    > (settings_.outbound_connections / 2))
     {
-        std::vector <address> temp;
-
-        // Critical Section
-        ///////////////////////////////////////////////////////////////////////////
-        shared_lock lock(peers_mutex_);
-
-        for (const auto& addr : peers_)
+        if (fetch_pinboard_address(out_address))
         {
-            if (addr.services() & (1u << PINBOARD_SERVICE_BIT))
-                temp.push_back(addr);
-        };
-
-        if (temp.size() > 0) {
-            LOG_INFO(LOG_NODE) << temp.size() << " pinboard nodes found in hosts_ list.";
-            for (const auto n : temp)
-            {
-                config::authority auth(n);
-                LOG_INFO(LOG_NODE) << "\t" << auth;
-            }
-            const auto random = pseudo_random(0, temp.size() - 1);
-            const auto index = static_cast<size_t>(random);
-            out_address = temp[index];
             LOG_INFO(LOG_NODE) << "Trying pinboard node " << config::authority(out_address);
             return error::success;
         }
-        ///////////////////////////////////////////////////////////////////////////
     }
 
     LOG_INFO(LOG_NODE) << "Trying litecoin node";
     return p2p<bc::network::message_subscriber_ex>::fetch_address(out_address);
 }
 
-/// Get all known addresses with given services advertised
-code lite_node::fetch_addresses(message::network_address::list& out_addresses, uint64_t services) const
+// Mostly the best scored of a few random candidates, sometimes just a random
+// one so that unmeasured peers get their chance.
+bool lite_node::fetch_pinboard_address(address& out_address) const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(peers_mutex_);
+    static const uint64_t services = 1u << PINBOARD_SERVICE_BIT;
 
-    for (const auto& addr : peers_)
-    {
-        if ((addr.services() & services) == services)
-            out_addresses.push_back(addr);
-    }
+    if (pseudo_random(0, exploration_ratio - 1) == 0)
+        return peers_.fetch_random(services, out_address);
+
+    address::list candidates;
+    candidates.reserve(peer_candidates);
+    peers_.sample(services, peer_candidates, candidates);
 
+    if (candidates.empty())
+        return false;
+
+    const auto best = std::min_element(candidates.begin(), candidates.end(),
+        [this](const address& left, const address& right)
+        {
+            return scores_.score(config::authority(left)) <
+                scores_.score(config::authority(right));
+        });
+
+    out_address = *best;
+    return true;
+}
+
+/// Get all known addresses with given services advertised
+code lite_node::fetch_addresses(message::network_address::list& out_addresses, uint64_t services) const
+{
+    peers_.fetch(services, out_addresses);
     return error::success;
-    ///////////////////////////////////////////////////////////////////////////
 }
 
 // Pending close collection (open connections).
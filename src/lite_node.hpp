@@ -18,13 +18,21 @@
 #ifndef LIBBITCOIN_NODE_LITE_NODE_HPP
 #define LIBBITCOIN_NODE_LITE_NODE_HPP
 
+#include <chrono>
 #include <cstdint>
+#include <map>
 #include <memory>
 
 #include <altcoin/network.hpp>
 
+#include "address_store.hpp"
 #include "chain_listener.hpp"
+#include "header_sync_scheduler.hpp"
+#include "object_request_tracker.hpp"
+#include "peer_scores.hpp"
 #include "pinboard.hpp"
+#include "prepared_message.hpp"
+#include "send_queue.hpp"
 #include "message_subscriber_ex.hpp"
 #include "config.hpp"
 
@@ -65,11 +73,27 @@ public:
         const auto join_handler = synchronize(handle_complete, pb_nodes,
                                               "p2p_join", synchronizer_terminate::on_count);
 
-        // No pre-serialize, channels may have different protocol versions.
+        // Serialize once per negotiated protocol version.
+        const auto magic = network_settings().identifier;
+        std::map<uint32_t, std::shared_ptr<const message::prepared<Message>>> prepared;
+
         for (const auto channel: channels)
-            if (channel->peer_version()->services() & (1u << PINBOARD_SERVICE_BIT))
-                channel->send(message, std::bind(&p2p::handle_send, this,
-                                                 std::placeholders::_1, channel, handle_channel, join_handler));
+        {
+            if (!(channel->peer_version()->services() & (1u << PINBOARD_SERVICE_BIT)))
+                continue;
+
+            const auto version = channel->negotiated_version();
+            auto& wire = prepared[version];
+            if (!wire)
+                wire = std::make_shared<const message::prepared<Message>>(message, version, magic);
+
+            const auto sent = std::bind(&p2p::handle_send, this,
+                                        std::placeholders::_1, channel, handle_channel, join_handler);
+
+            // A peer whose queue is full misses the broadcast.
+            if (!outbound(channel)->send(send_queue::priority::fresh, wire, sent))
+                sent(error::operation_failed);
+        }
     }
 
     // Start/Run sequences.
@@ -91,6 +115,11 @@ public:
     /// Get all known addresses with given services advertised
     virtual code fetch_addresses(message::network_address::list& out_addresses, uint64_t services) const;
 
+    /// Random sample of the pinboard addresses, one less than max_address
+    /// to leave room for our own. Shared by all get_address answers for a
+    /// while, so answering costs the same however many hosts are known.
+    address_const_ptr sample_pinboard_addresses();
+
     /// Store a collection of addresses (asynchronous).
     virtual void store(const address::list& addresses, result_handler handler);
 
@@ -121,6 +150,19 @@ public:
     /// Return the current top block identity.
     virtual config::checkpoint top_block() const;
 
+    /// Coordinator of header requests across channels.
+    header_sync_scheduler& header_scheduler();
+
+    /// Pinboard objects announced by peers and requested from them.
+    object_request_tracker& object_tracker();
+
+    /// How well pinboard peers served us, used to pick outbound peers.
+    peer_scores& scores();
+
+    /// Outbound scheduler of channel, created on first use and dropped
+    /// when the channel stops.
+    send_queue::ptr outbound(send_queue::channel_ptr channel);
+
 protected:
     /// Attach a node::session to the network, caller must start the session.
     template <class Session, typename... Args>
@@ -134,9 +176,7 @@ protected:
     typename network::session_inbound<libbitcoin::network::message_subscriber_ex>::ptr attach_inbound_session() override;
     typename network::session_outbound<libbitcoin::network::message_subscriber_ex>::ptr attach_outbound_session() override;
 
-    typedef boost::circular_buffer<address> host_list;
-    mutable upgrade_mutex peers_mutex_;
-    host_list peers_;
+    address_store peers_;
 
 private:
     typedef message::block::ptr_list block_ptr_list;
@@ -147,10 +187,22 @@ private:
     void handle_started(const code& ec, result_handler handler);
     void handle_running(const code& ec, result_handler handler);
 
+    bool fetch_pinboard_address(address& out_address) const;
+
     // These are thread safe.
     const uint32_t protocol_maximum_;
     chain_sync_state::ptr chain_state_;
     pinboard::ptr pinboard_;
+    header_sync_scheduler header_scheduler_;
+    object_request_tracker object_tracker_;
+    peer_scores scores_;
+
+    mutable upgrade_mutex outbound_mutex_;
+    std::map<uint64_t, send_queue::ptr> outbound_;
+
+    mutable upgrade_mutex address_sample_mutex_;
+    address_const_ptr address_sample_;
+    std::chrono::steady_clock::time_point address_sample_expiry_;
 };
 
 } // namespace node
@@ -15,6 +15,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <iostream>
 #include <future>
 #include <chrono>
@@ -50,8 +51,11 @@ struct parameters
     bool action_print_and_exit = false;
     bool action_submit_and_exit = false;
     bool dont_guess_external_ip = false;
+    bool light_pow = false;
 
     string manually_set_ip;
+    string headers_file = "headers.dat";
+    size_t prune_horizon = 0;
 
     string new_message_body;  // for "submit" action
 };
@@ -72,7 +76,9 @@ int main(int argc, char* argv[])
 
         // Create everything
         auto mb = make_shared<message_broadcaster>();
-        auto ch = make_shared<chain_sync_state>(mb, last_known_checkpoint);
+        auto ch = make_shared<chain_sync_state>(mb, last_known_checkpoint, param.headers_file,
+                                                param.prune_horizon);
+        ch->start();
         auto pb = make_shared<pinboard>(mb, ch, MIN_TARGET);
         pb->start([](const bc::code&){});
         auto ln = make_shared<lite_node>(settings, ch, pb);
@@ -105,19 +111,42 @@ int main(int argc, char* argv[])
 
                 if (param.action_submit_and_exit)
                 {
-                    std::this_thread::sleep_for(std::chrono::seconds(10));
-                    while (!ch->is_synchronized())
+                    // Wake up on tip changes instead of polling.
+                    auto synced = make_shared<promise<void>>();
+                    auto done = make_shared<atomic<bool>>(false);
+                    const auto finish = [synced, done]()
                     {
+                        if (!done->exchange(true))
+                            synced->set_value();
+                    };
+
+                    ch->subscribe_tip([&ch, finish, done](const bc::code &ec, const bc::hash_digest&,
+                                                         const bc::hash_digest&, size_t)
+                    {
+                        if (*done)
+                            return false;
+
+                        if (ec || ch->is_synchronized())
+                        {
+                            finish();
+                            return false;
+                        }
+
+                        return true;
+                    });
+
+                    if (ch->is_synchronized())
+                        finish();
+                    else
                         LOG_INFO(LOG_MAIN) << "Waiting for blockchain sync ... ";
-                        std::this_thread::sleep_for(std::chrono::seconds(10));
-                    }
+
+                    synced->get_future().wait();
                     LOG_INFO(LOG_MAIN) << "Starting miner ... ";
 
                     auto msg = make_shared<object_payload>(param.new_message_body);
-                    auto mn = make_shared<miner<default_pow>>(msg, ch);
 
                     const bc::uint256_t target = MIN_TARGET;
-                    mn->start_mining(target, [&ln, &ch, &mb](const bc::code &ec, object_payload::ptr obj)
+                    const auto mined = [&ln, &ch, &mb](const bc::code &ec, object_payload::ptr obj)
                     {
                         LOG_INFO(LOG_MAIN) << "miner::start_mining got ec == " << ec;
                         LOG_INFO(LOG_MAIN) << "nonce = " << obj->get_nonce() << " work_done = " << obj->get_work_done();
@@ -149,7 +178,13 @@ int main(int argc, char* argv[])
                             LOG_INFO(LOG_MAIN) << "Shutdown complete.";
                             exit(EXIT_SUCCESS);
                         });
-                    });
+                    };
+
+                    if (param.light_pow)
+                        make_shared<miner<pow_scrypt_10_1_1>>(msg, ch)->start_mining(
+                            pow_algorithms::find(pow_scrypt_10_1_1::type())->equivalent_target(target), mined);
+                    else
+                        make_shared<miner<default_pow>>(msg, ch)->start_mining(target, mined);
                 }
             });
         });
@@ -159,7 +194,7 @@ int main(int argc, char* argv[])
         boost::asio::signal_set signals(io_service, SIGINT, SIGTERM);
 
         // Start an asynchronous wait for one of the signals to occur.
-        signals.async_wait([&ln, &pb](const boost::system::error_code &error, int signal_number) {
+        signals.async_wait([&ln, &pb, &ch](const boost::system::error_code &error, int signal_number) {
             cout << "Signal " << signal_number << " is caught. Shutting down." << endl;
 
             if (!ln->stop())
@@ -168,6 +203,7 @@ int main(int argc, char* argv[])
                 LOG_INFO(LOG_MAIN) << "Shutdown complete.";
 
             pb->stop();
+            ch->stop();
         });
 
         io_service.run();
@@ -206,6 +242,7 @@ parameters parse_command_line(int argc, char* argv[], bc::network::settings& set
             ("help,h", "This help message")
             ("print,p", "Print all messages from pinboard and exit")
             ("submit,s", "Submit message from STDIN and exit")
+            ("light-pow", "Submit with the cheaper scrypt(N=1024, r=1, p=1) PoW, shorter TTL per hash")
             ("inbound-port,i",
              value<uint16_t>(&settings.inbound_port)->implicit_value(29333),
              "Inbound port for p2p communication")
@@ -214,6 +251,10 @@ parameters parse_command_line(int argc, char* argv[], bc::network::settings& set
             ("max-addresses", value<uint32_t>(), "Store at most <arg> peer addresses")
             ("connect-to", value<vector<string>>()->multitoken()->composing(), "List of peers to connect to" )
             ("set-ip", value<string>(), "Store at most <arg> peer addresses")
+            ("headers-file", value<string>(&param.headers_file),
+             "Keep block headers in <arg> across restarts, empty to disable (default headers.dat)")
+            ("prune-horizon", value<size_t>(&param.prune_horizon),
+             "Keep only the last <arg> block headers in memory (at least 2000, default keeps all)")
             ("dont-use-seeds", "Don't ask Litecoin seeds for peer addresses" )
             ("dont-guess-ip", "Don't guess external ip" );
 
@@ -263,6 +304,11 @@ parameters parse_command_line(int argc, char* argv[], bc::network::settings& set
         param.action_submit_and_exit = true;
     }
 
+    if (vm.count("light-pow"))
+    {
+        param.light_pow = true;
+    }
+
     if (vm.count("connect-to"))
     {
         for (auto item : vm["connect-to"].as<std::vector<std::string>>())
@@ -316,6 +362,7 @@ bc::network::settings get_network_settings(bool mainnet)
 
     s.services = bc::message::version::service::node_network;
     s.services |= (1u << PINBOARD_SERVICE_BIT);
+    s.services |= (1u << PINBOARD_COMPRESSION_BIT);
 
     s.manual_attempt_limit = 0;
     s.connect_batch_size = 1;
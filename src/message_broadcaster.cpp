@@ -33,6 +33,7 @@ using namespace bc::message;
 
 template void message_broadcaster::broadcast_to_pb<object>(const object&, channel_handler, result_handler);
 template void message_broadcaster::broadcast_to_pb<inventory>(const inventory&, channel_handler, result_handler);
+template void message_broadcaster::broadcast_to_pb<object_inventory>(const object_inventory&, channel_handler, result_handler);
 
 }
 }
\ No newline at end of file
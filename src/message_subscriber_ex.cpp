@@ -20,12 +20,15 @@
 
 // copy/paste from libbitcoin-network/src/message_subscriber.cpp
 
-#define INITIALIZE_SUBSCRIBER(pool, value) \
-    value##_subscriber_(std::make_shared<value##_subscriber_type>( \
+#define INITIALIZE_SUBSCRIBER(value) \
+    , value##_subscriber_(std::make_shared<value##_subscriber_type>( \
         pool, #value "_sub"))
 
-#define RELAY_CODE(code, value) \
-    value##_subscriber_->relay(code, {})
+#define REGISTER_MESSAGE(value) \
+    register_message<message::value>(value##_subscriber_);
+
+#define RELAY_CODE(value) \
+    value##_subscriber_->relay(ec, {});
 
 // This allows us to block the peer while handling the message.
 #define CASE_HANDLE_MESSAGE(stream, version, value) \
@@ -37,10 +40,10 @@
         return relay<message::value>(stream, version, value##_subscriber_)
 
 #define START_SUBSCRIBER(value) \
-    value##_subscriber_->start()
+    value##_subscriber_->start();
 
 #define STOP_SUBSCRIBER(value) \
-    value##_subscriber_->stop()
+    value##_subscriber_->stop();
 
 namespace libbitcoin {
 namespace network {
@@ -48,68 +51,20 @@ namespace network {
 using namespace message;
 
 message_subscriber_ex::message_subscriber_ex(threadpool& pool)
-        : message_subscriber(pool),
-    INITIALIZE_SUBSCRIBER(pool, address),
-    INITIALIZE_SUBSCRIBER(pool, alert),
-    INITIALIZE_SUBSCRIBER(pool, block),
-    INITIALIZE_SUBSCRIBER(pool, block_transactions),
-    INITIALIZE_SUBSCRIBER(pool, compact_block),
-    INITIALIZE_SUBSCRIBER(pool, fee_filter),
-    INITIALIZE_SUBSCRIBER(pool, filter_add),
-    INITIALIZE_SUBSCRIBER(pool, filter_clear),
-    INITIALIZE_SUBSCRIBER(pool, filter_load),
-    INITIALIZE_SUBSCRIBER(pool, get_address),
-    INITIALIZE_SUBSCRIBER(pool, get_blocks),
-    INITIALIZE_SUBSCRIBER(pool, get_block_transactions),
-    INITIALIZE_SUBSCRIBER(pool, get_data),
-    INITIALIZE_SUBSCRIBER(pool, get_headers),
-    INITIALIZE_SUBSCRIBER(pool, headers),
-    INITIALIZE_SUBSCRIBER(pool, inventory),
-    INITIALIZE_SUBSCRIBER(pool, memory_pool),
-    INITIALIZE_SUBSCRIBER(pool, merkle_block),
-    INITIALIZE_SUBSCRIBER(pool, not_found),
-    INITIALIZE_SUBSCRIBER(pool, ping),
-    INITIALIZE_SUBSCRIBER(pool, pong),
-    INITIALIZE_SUBSCRIBER(pool, reject),
-    INITIALIZE_SUBSCRIBER(pool, send_compact),
-    INITIALIZE_SUBSCRIBER(pool, send_headers),
-    INITIALIZE_SUBSCRIBER(pool, transaction),
-    INITIALIZE_SUBSCRIBER(pool, verack),
-    INITIALIZE_SUBSCRIBER(pool, version),
-    INITIALIZE_SUBSCRIBER(pool, object)
+  : message_subscriber(pool)
+    BITCOIN_MESSAGE_TYPES(INITIALIZE_SUBSCRIBER)
+    PINBOARD_MESSAGE_TYPES(INITIALIZE_SUBSCRIBER)
 {
+    PINBOARD_MESSAGE_TYPES(REGISTER_MESSAGE)
+
+    // Objects in the compact encoding go to object subscribers.
+    register_message<message::compressed_object>(object_subscriber_);
 }
 
 void message_subscriber_ex::broadcast(const code& ec)
 {
-    RELAY_CODE(ec, address);
-    RELAY_CODE(ec, alert);
-    RELAY_CODE(ec, block);
-    RELAY_CODE(ec, block_transactions);
-    RELAY_CODE(ec, compact_block);
-    RELAY_CODE(ec, fee_filter);
-    RELAY_CODE(ec, filter_add);
-    RELAY_CODE(ec, filter_clear);
-    RELAY_CODE(ec, filter_load);
-    RELAY_CODE(ec, get_address);
-    RELAY_CODE(ec, get_blocks);
-    RELAY_CODE(ec, get_block_transactions);
-    RELAY_CODE(ec, get_data);
-    RELAY_CODE(ec, get_headers);
-    RELAY_CODE(ec, headers);
-    RELAY_CODE(ec, inventory);
-    RELAY_CODE(ec, memory_pool);
-    RELAY_CODE(ec, merkle_block);
-    RELAY_CODE(ec, not_found);
-    RELAY_CODE(ec, ping);
-    RELAY_CODE(ec, pong);
-    RELAY_CODE(ec, reject);
-    RELAY_CODE(ec, send_compact);
-    RELAY_CODE(ec, send_headers);
-    RELAY_CODE(ec, transaction);
-    RELAY_CODE(ec, verack);
-    RELAY_CODE(ec, version);
-    RELAY_CODE(ec, object);
+    BITCOIN_MESSAGE_TYPES(RELAY_CODE)
+    PINBOARD_MESSAGE_TYPES(RELAY_CODE)
 }
 
 code message_subscriber_ex::load(const heading& head, uint32_t version,
@@ -146,8 +101,13 @@ code message_subscriber_ex::load(const heading& head, uint32_t version,
         CASE_HANDLE_MESSAGE(stream, version, version);
 
         case message_type::unknown:
-            if (head.command() == "object")
-                return relay<message::object>(stream, version, object_subscriber_);
+        {
+            const auto loader = loaders_.find(head.command());
+            if (loader != loaders_.end())
+                return loader->second(head, version, stream);
+
+            return error::not_found;
+        }
 
         default:
             return error::not_found;
@@ -156,67 +116,15 @@ code message_subscriber_ex::load(const heading& head, uint32_t version,
 
 void message_subscriber_ex::start()
 {
-    START_SUBSCRIBER(address);
-    START_SUBSCRIBER(alert);
-    START_SUBSCRIBER(block);
-    START_SUBSCRIBER(block_transactions);
-    START_SUBSCRIBER(compact_block);
-    START_SUBSCRIBER(fee_filter);
-    START_SUBSCRIBER(filter_add);
-    START_SUBSCRIBER(filter_clear);
-    START_SUBSCRIBER(filter_load);
-    START_SUBSCRIBER(get_address);
-    START_SUBSCRIBER(get_blocks);
-    START_SUBSCRIBER(get_block_transactions);
-    START_SUBSCRIBER(get_data);
-    START_SUBSCRIBER(get_headers);
-    START_SUBSCRIBER(headers);
-    START_SUBSCRIBER(inventory);
-    START_SUBSCRIBER(memory_pool);
-    START_SUBSCRIBER(merkle_block);
-    START_SUBSCRIBER(not_found);
-    START_SUBSCRIBER(ping);
-    START_SUBSCRIBER(pong);
-    START_SUBSCRIBER(reject);
-    START_SUBSCRIBER(send_compact);
-    START_SUBSCRIBER(send_headers);
-    START_SUBSCRIBER(transaction);
-    START_SUBSCRIBER(verack);
-    START_SUBSCRIBER(version);
-    START_SUBSCRIBER(object);
+    BITCOIN_MESSAGE_TYPES(START_SUBSCRIBER)
+    PINBOARD_MESSAGE_TYPES(START_SUBSCRIBER)
 }
 
 void message_subscriber_ex::stop()
 {
-    STOP_SUBSCRIBER(address);
-    STOP_SUBSCRIBER(alert);
-    STOP_SUBSCRIBER(block);
-    STOP_SUBSCRIBER(block_transactions);
-    STOP_SUBSCRIBER(compact_block);
-    STOP_SUBSCRIBER(fee_filter);
-    STOP_SUBSCRIBER(filter_add);
-    STOP_SUBSCRIBER(filter_clear);
-    STOP_SUBSCRIBER(filter_load);
-    STOP_SUBSCRIBER(get_address);
-    STOP_SUBSCRIBER(get_blocks);
-    STOP_SUBSCRIBER(get_block_transactions);
-    STOP_SUBSCRIBER(get_data);
-    STOP_SUBSCRIBER(get_headers);
-    STOP_SUBSCRIBER(headers);
-    STOP_SUBSCRIBER(inventory);
-    STOP_SUBSCRIBER(memory_pool);
-    STOP_SUBSCRIBER(merkle_block);
-    STOP_SUBSCRIBER(not_found);
-    STOP_SUBSCRIBER(ping);
-    STOP_SUBSCRIBER(pong);
-    STOP_SUBSCRIBER(reject);
-    STOP_SUBSCRIBER(send_compact);
-    STOP_SUBSCRIBER(send_headers);
-    STOP_SUBSCRIBER(transaction);
-    STOP_SUBSCRIBER(verack);
-    STOP_SUBSCRIBER(version);
-    STOP_SUBSCRIBER(object);
+    BITCOIN_MESSAGE_TYPES(STOP_SUBSCRIBER)
+    PINBOARD_MESSAGE_TYPES(STOP_SUBSCRIBER)
 }
 
 }
-}
\ No newline at end of file
+}
@@ -18,18 +18,64 @@
 #ifndef LIBBITCOIN_MESSAGE_SUBSCRIBER_EX_HPP
 #define LIBBITCOIN_MESSAGE_SUBSCRIBER_EX_HPP
 
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <altcoin/network/message_subscriber.hpp>
 
+#include "board_sketch.hpp"
 #include "object.hpp"
+#include "object_inventory.hpp"
 
 namespace libbitcoin {
 namespace network {
 
+// Messages with a subscriber. Those of the bitcoin protocol are dispatched
+// by message_type, pinboard messages by command through the registry. A new
+// pinboard message only has to be added to the second list.
+#define BITCOIN_MESSAGE_TYPES(ACTION) \
+    ACTION(address) \
+    ACTION(alert) \
+    ACTION(block) \
+    ACTION(block_transactions) \
+    ACTION(compact_block) \
+    ACTION(fee_filter) \
+    ACTION(filter_add) \
+    ACTION(filter_clear) \
+    ACTION(filter_load) \
+    ACTION(get_address) \
+    ACTION(get_blocks) \
+    ACTION(get_block_transactions) \
+    ACTION(get_data) \
+    ACTION(get_headers) \
+    ACTION(headers) \
+    ACTION(inventory) \
+    ACTION(memory_pool) \
+    ACTION(merkle_block) \
+    ACTION(not_found) \
+    ACTION(ping) \
+    ACTION(pong) \
+    ACTION(reject) \
+    ACTION(send_compact) \
+    ACTION(send_headers) \
+    ACTION(transaction) \
+    ACTION(verack) \
+    ACTION(version)
+
+#define PINBOARD_MESSAGE_TYPES(ACTION) \
+    ACTION(object) \
+    ACTION(object_inventory) \
+    ACTION(get_objects) \
+    ACTION(board_sketch)
+
 // copy/paste from libbitcoin-network/include/bitcoin/network/message_subscriber.hpp
 
 #define DEFINE_SUBSCRIBER_TYPE(value) \
     typedef resubscriber<code, message::value::const_ptr> \
-        value##_subscriber_type
+        value##_subscriber_type;
 
 #define DEFINE_SUBSCRIBER_OVERLOAD(value) \
     template <typename Handler> \
@@ -40,38 +86,12 @@ namespace network {
     }
 
 #define DECLARE_SUBSCRIBER(value) \
-    value##_subscriber_type::ptr value##_subscriber_
+    value##_subscriber_type::ptr value##_subscriber_;
 
 class BCT_API message_subscriber_ex : public message_subscriber {
 public:
-    DEFINE_SUBSCRIBER_TYPE(address);
-    DEFINE_SUBSCRIBER_TYPE(alert);
-    DEFINE_SUBSCRIBER_TYPE(block);
-    DEFINE_SUBSCRIBER_TYPE(block_transactions);
-    DEFINE_SUBSCRIBER_TYPE(compact_block);
-    DEFINE_SUBSCRIBER_TYPE(fee_filter);
-    DEFINE_SUBSCRIBER_TYPE(filter_add);
-    DEFINE_SUBSCRIBER_TYPE(filter_clear);
-    DEFINE_SUBSCRIBER_TYPE(filter_load);
-    DEFINE_SUBSCRIBER_TYPE(get_address);
-    DEFINE_SUBSCRIBER_TYPE(get_blocks);
-    DEFINE_SUBSCRIBER_TYPE(get_block_transactions);
-    DEFINE_SUBSCRIBER_TYPE(get_data);
-    DEFINE_SUBSCRIBER_TYPE(get_headers);
-    DEFINE_SUBSCRIBER_TYPE(headers);
-    DEFINE_SUBSCRIBER_TYPE(inventory);
-    DEFINE_SUBSCRIBER_TYPE(memory_pool);
-    DEFINE_SUBSCRIBER_TYPE(merkle_block);
-    DEFINE_SUBSCRIBER_TYPE(not_found);
-    DEFINE_SUBSCRIBER_TYPE(ping);
-    DEFINE_SUBSCRIBER_TYPE(pong);
-    DEFINE_SUBSCRIBER_TYPE(reject);
-    DEFINE_SUBSCRIBER_TYPE(send_compact);
-    DEFINE_SUBSCRIBER_TYPE(send_headers);
-    DEFINE_SUBSCRIBER_TYPE(transaction);
-    DEFINE_SUBSCRIBER_TYPE(verack);
-    DEFINE_SUBSCRIBER_TYPE(version);
-    DEFINE_SUBSCRIBER_TYPE(object);
+    BITCOIN_MESSAGE_TYPES(DEFINE_SUBSCRIBER_TYPE)
+    PINBOARD_MESSAGE_TYPES(DEFINE_SUBSCRIBER_TYPE)
 
     /**
      * Create an instance of this class.
@@ -120,63 +140,48 @@ public:
     virtual void stop();
 
 private:
-    DEFINE_SUBSCRIBER_OVERLOAD(address);
-    DEFINE_SUBSCRIBER_OVERLOAD(alert);
-    DEFINE_SUBSCRIBER_OVERLOAD(block);
-    DEFINE_SUBSCRIBER_OVERLOAD(block_transactions);
-    DEFINE_SUBSCRIBER_OVERLOAD(compact_block);
-    DEFINE_SUBSCRIBER_OVERLOAD(fee_filter);
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_add);
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_clear);
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_load);
-    DEFINE_SUBSCRIBER_OVERLOAD(get_address);
-    DEFINE_SUBSCRIBER_OVERLOAD(get_blocks);
-    DEFINE_SUBSCRIBER_OVERLOAD(get_block_transactions);
-    DEFINE_SUBSCRIBER_OVERLOAD(get_data);
-    DEFINE_SUBSCRIBER_OVERLOAD(get_headers);
-    DEFINE_SUBSCRIBER_OVERLOAD(headers);
-    DEFINE_SUBSCRIBER_OVERLOAD(inventory);
-    DEFINE_SUBSCRIBER_OVERLOAD(memory_pool);
-    DEFINE_SUBSCRIBER_OVERLOAD(merkle_block);
-    DEFINE_SUBSCRIBER_OVERLOAD(not_found);
-    DEFINE_SUBSCRIBER_OVERLOAD(ping);
-    DEFINE_SUBSCRIBER_OVERLOAD(pong);
-    DEFINE_SUBSCRIBER_OVERLOAD(reject);
-    DEFINE_SUBSCRIBER_OVERLOAD(send_compact);
-    DEFINE_SUBSCRIBER_OVERLOAD(send_headers);
-    DEFINE_SUBSCRIBER_OVERLOAD(transaction);
-    DEFINE_SUBSCRIBER_OVERLOAD(verack);
-    DEFINE_SUBSCRIBER_OVERLOAD(version);
-    DEFINE_SUBSCRIBER_OVERLOAD(object);
-
-    DECLARE_SUBSCRIBER(address);
-    DECLARE_SUBSCRIBER(alert);
-    DECLARE_SUBSCRIBER(block);
-    DECLARE_SUBSCRIBER(block_transactions);
-    DECLARE_SUBSCRIBER(compact_block);
-    DECLARE_SUBSCRIBER(fee_filter);
-    DECLARE_SUBSCRIBER(filter_add);
-    DECLARE_SUBSCRIBER(filter_clear);
-    DECLARE_SUBSCRIBER(filter_load);
-    DECLARE_SUBSCRIBER(get_address);
-    DECLARE_SUBSCRIBER(get_blocks);
-    DECLARE_SUBSCRIBER(get_block_transactions);
-    DECLARE_SUBSCRIBER(get_data);
-    DECLARE_SUBSCRIBER(get_headers);
-    DECLARE_SUBSCRIBER(headers);
-    DECLARE_SUBSCRIBER(inventory);
-    DECLARE_SUBSCRIBER(memory_pool);
-    DECLARE_SUBSCRIBER(merkle_block);
-    DECLARE_SUBSCRIBER(not_found);
-    DECLARE_SUBSCRIBER(ping);
-    DECLARE_SUBSCRIBER(pong);
-    DECLARE_SUBSCRIBER(reject);
-    DECLARE_SUBSCRIBER(send_compact);
-    DECLARE_SUBSCRIBER(send_headers);
-    DECLARE_SUBSCRIBER(transaction);
-    DECLARE_SUBSCRIBER(verack);
-    DECLARE_SUBSCRIBER(version);
-    DECLARE_SUBSCRIBER(object);
+    typedef std::function<code(const bc::message::heading&, uint32_t,
+        std::istream&)> loader;
+
+    // Pinboard messages are read from the stream in one piece and decoded
+    // from the buffer, see span_reader.
+    template <class Message, class Subscriber>
+    static code relay_payload(const bc::message::heading& head, uint32_t version,
+        std::istream& stream, const Subscriber& subscriber)
+    {
+        data_chunk payload(head.payload_size());
+        stream.read(reinterpret_cast<char*>(payload.data()), payload.size());
+        if (static_cast<size_t>(stream.gcount()) != payload.size())
+            return error::bad_stream;
+
+        const auto instance = std::make_shared<Message>();
+        if (!instance->from_data(version, payload))
+            return error::bad_stream;
+
+        subscriber->relay(error::success, instance);
+        return error::success;
+    }
+
+    // Decode messages with the command of Message for subscriber, which may
+    // be that of a base type.
+    template <class Message, class Subscriber>
+    void register_message(const Subscriber& subscriber)
+    {
+        loaders_[Message::command] = [subscriber](const bc::message::heading& head,
+            uint32_t version, std::istream& stream)
+        {
+            return relay_payload<Message>(head, version, stream, subscriber);
+        };
+    }
+
+    BITCOIN_MESSAGE_TYPES(DEFINE_SUBSCRIBER_OVERLOAD)
+    PINBOARD_MESSAGE_TYPES(DEFINE_SUBSCRIBER_OVERLOAD)
+
+    BITCOIN_MESSAGE_TYPES(DECLARE_SUBSCRIBER)
+    PINBOARD_MESSAGE_TYPES(DECLARE_SUBSCRIBER)
+
+    // Built by the constructor, read only afterwards.
+    std::unordered_map<std::string, loader> loaders_;
 };
 
 #undef DEFINE_SUBSCRIBER_TYPE
@@ -186,4 +191,4 @@ private:
 }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -55,18 +55,36 @@ void miner<F>::start_mining(const uint256_t &target, result_handler handler)
     LOG_INFO(LOG_MINER) << "estimated work = " << estimated_work
                         << ", starting from nonce = " << start_nonce;
 
+    // Anchor to the latest tip, without asking chain_sync_state per nonce.
+    const auto state = make_shared<anchor_state>();
+    chain_state_->subscribe_tip([state](const bc::code& ec, const hash_digest&,
+                                        const hash_digest& new_tip, size_t)
+    {
+        if (ec || state->done)
+            return false;
+
+        unique_lock lock(state->mutex);
+        state->anchor = new_tip;
+        state->changed = true;
+        return true;
+    });
+
+    {
+        unique_lock lock(state->mutex);
+        if (!state->changed)
+            state->anchor = chain_state_->get_snapshot()->tip().hash;
+        state->changed = false;
+        obj_->pow_.anchor_ = state->anchor;
+    }
+
     auto start = chrono::steady_clock::now();
     for (nonce = start_nonce; nonce <numeric_limits<uint64_t>::max(); nonce++)
     {
-        const std::set<bc::hash_digest> top = chain_state_->get_last_known_block_hash();
-        // this is very uneffective due to locks in chain_sync_state
-
-        if (top.empty())
+        if (state->changed.exchange(false))
         {
-            ec = bc::error::unknown;
-            break;
+            shared_lock lock(state->mutex);
+            obj_->pow_.anchor_ = state->anchor;
         }
-        obj_->pow_.anchor_ = *top.begin();
 
         data_chunk data = obj_->serialize_id_and_pow();
         h = F::calculate(data);
@@ -85,6 +103,7 @@ void miner<F>::start_mining(const uint256_t &target, result_handler handler)
         }
     }
 
+    state->done = true;
     LOG_INFO(LOG_MINER) << "ec == " << ec;
 
     handler(ec, obj_);
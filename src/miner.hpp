@@ -17,6 +17,9 @@
 #ifndef LIBBITCOIN_MINER_HPP
 #define LIBBITCOIN_MINER_HPP
 
+#include <atomic>
+#include <memory>
+
 #include "object.hpp"
 #include "chain_listener.hpp"
 
@@ -38,6 +41,16 @@ public:
     void start_mining(const uint256_t &target, result_handler handler);
 
 private:
+    // Anchor updated by tip notifications, shared with the subscription
+    // which may outlive the miner.
+    struct anchor_state
+    {
+        upgrade_mutex mutex;
+        hash_digest anchor = null_hash;
+        std::atomic<bool> changed{false};
+        std::atomic<bool> done{false};
+    };
+
     object_payload::ptr obj_;
     chain_sync_state::ptr chain_state_;
 };
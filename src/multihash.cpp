@@ -28,6 +28,7 @@
 #include <bitcoin/bitcoin/formats/base_58.hpp>
 
 #include "multihash.hpp"
+#include "span_reader.hpp"
 
 namespace libbitcoin {
 namespace message {
@@ -75,8 +76,8 @@ multihash::multihash(digest_type fn_code, const data_chunk& digest)
 
 bool multihash::from_data(uint32_t version, const data_chunk& data)
 {
-    data_source istream(data);
-    return from_data(version, istream);
+    span_reader source(data);
+    return from_data(version, source);
 }
 
 bool multihash::from_data(uint32_t version, std::istream& stream)
@@ -15,7 +15,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
+#include <exception>
 #include <sstream>
+#include <string>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 
 #include <bitcoin/bitcoin/math/limits.hpp>
 #include <bitcoin/bitcoin/message/messages.hpp>
@@ -27,10 +35,51 @@
 #include <bitcoin/bitcoin/utility/ostream_writer.hpp>
 
 #include "object.hpp"
+#include "span_reader.hpp"
 
 namespace libbitcoin {
 namespace message {
 
+namespace io = boost::iostreams;
+
+// A compressed body may not inflate beyond this, a plain one is bounded by
+// the message size.
+static const size_t max_body_size = 4 * 1024 * 1024;
+
+// Flags of the compact encoding.
+static const uint8_t body_compressed = 0x01;
+
+static data_chunk deflate(const data_chunk& data)
+{
+    std::string out;
+    io::filtering_ostream stream;
+    stream.push(io::zlib_compressor(io::zlib::best_compression));
+    stream.push(io::back_inserter(out));
+    stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    stream.reset();
+    return data_chunk(out.begin(), out.end());
+}
+
+// False unless data is a zlib stream of exactly size bytes.
+static bool inflate(const data_chunk& data, size_t size, data_chunk& out)
+{
+    out.resize(size);
+
+    try
+    {
+        io::filtering_istream stream;
+        stream.push(io::zlib_decompressor());
+        stream.push(io::array_source(reinterpret_cast<const char*>(data.data()), data.size()));
+        stream.read(reinterpret_cast<char*>(out.data()), size);
+
+        return static_cast<size_t>(stream.gcount()) == size && stream.get() == EOF;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
 object_payload object_payload::factory_from_data(uint32_t version, const data_chunk& data)
 {
     object_payload instance;
@@ -53,36 +102,44 @@ object_payload object_payload::factory_from_data(uint32_t version, reader& sourc
 }
 
 object_payload::object_payload()
-    : validation{}, body_(), body_id_(), pow_()
+    : validation{}, body_(), body_size_(0), compressed_(false), body_id_(), pow_()
 {
 }
 
+// The id and PoW are kept, a compressed body would have to be inflated to
+// compute them again.
 object_payload::object_payload(const object_payload& other)
-    : validation{}, body_(other.body_), body_id_(other.body_id_), pow_(other.pow_)
+    : validation(other.validation), body_(other.body_), body_size_(other.body_size_),
+      compressed_(other.compressed_), body_id_(other.body_id_), pow_(other.pow_)
 {
 }
 
 object_payload::object_payload(object_payload&& other) noexcept
-    : validation{}, body_(std::move(other.body_)), body_id_(std::move(other.body_id_)), pow_(std::move(other.pow_))
+    : validation(other.validation), body_(std::move(other.body_)), body_size_(other.body_size_),
+      compressed_(other.compressed_), body_id_(std::move(other.body_id_)), pow_(std::move(other.pow_))
 {
 }
 
 object_payload::object_payload(const std::string &str)
-        : body_(str.cbegin(), str.cend()), body_id_(), pow_()
+        : validation{}, body_(str.cbegin(), str.cend()), body_size_(str.size()), compressed_(false),
+          body_id_(), pow_()
 {
 }
 
 void object_payload::reset()
 {
+    validation = {};
     body_.clear();
+    body_size_ = 0;
+    compressed_ = false;
     body_id_.reset();
     pow_.reset();
 }
 
 bool object_payload::from_data(uint32_t version, const data_chunk& data)
 {
-    data_source istream(data);
-    return from_data(version, istream);
+    span_reader source(data);
+    return from_data(version, source);
 }
 
 bool object_payload::from_data(uint32_t version, std::istream& stream)
@@ -95,9 +152,9 @@ bool object_payload::from_data(uint32_t version, reader& source)
 {
     reset();
 
-    const auto body_size = source.read_size_little_endian();
-    if (body_size > 0)
-        body_ = source.read_bytes(body_size);
+    body_size_ = source.read_size_little_endian();
+    if (body_size_ > 0)
+        body_ = source.read_bytes(body_size_);
     else
         body_id_.from_data(version, source);
 
@@ -129,7 +186,89 @@ void object_payload::to_data(uint32_t version, std::ostream& stream) const
 
 void object_payload::to_data(uint32_t version, writer& sink) const
 {
-    sink.write_size_little_endian(body_.size());
+    if (compressed_)
+        to_data(version, sink, body());
+    else
+        to_data(version, sink, body_);
+}
+
+void object_payload::to_data(uint32_t version, writer& sink, const data_chunk& body) const
+{
+    sink.write_size_little_endian(body.size());
+
+    if (!body.empty())
+        sink.write_bytes(body);
+    else
+        body_id_.to_data(version, sink);
+
+    pow_.to_data(version, sink);
+}
+
+bool object_payload::from_compact_data(uint32_t version, reader& source)
+{
+    reset();
+
+    const auto flags = source.read_byte();
+    if ((flags & ~body_compressed) != 0)
+        source.invalidate();
+
+    body_size_ = source.read_size_little_endian();
+    compressed_ = (flags & body_compressed) != 0;
+
+    // Check the stream once, the ids and PoW need the plain body anyway.
+    data_chunk plain;
+
+    if (body_size_ == 0)
+    {
+        if (compressed_)
+            source.invalidate();
+        else
+            body_id_.from_data(version, source);
+    }
+    else if (!compressed_)
+        body_ = source.read_bytes(body_size_);
+    else if (body_size_ > max_body_size)
+        source.invalidate();
+    else
+    {
+        const auto stored_size = source.read_size_little_endian();
+        if (stored_size < body_size_)
+            body_ = source.read_bytes(stored_size);
+        else
+            source.invalidate();
+
+        if (source && inflate(body_, body_size_, plain))
+            body_id_ = multihash(digest_type::sha2_256, sha256_hash_chunk(plain));
+        else
+            source.invalidate();
+    }
+
+    pow_.from_data(version, source);
+
+    // The id covers the PoW certificate, so it is computed after it.
+    if (source && compressed_)
+    {
+        data_chunk data;
+        data_sink ostream(data);
+        ostream_writer sink(ostream);
+        to_data(0, sink, plain);
+        ostream.flush();
+        validation.id = sha256_hash(data);
+    }
+
+    if (!source)
+        reset();
+
+    return source;
+}
+
+void object_payload::to_compact_data(uint32_t version, writer& sink) const
+{
+    sink.write_byte(compressed_ ? body_compressed : 0);
+    sink.write_size_little_endian(body_size_);
+
+    if (compressed_)
+        sink.write_size_little_endian(body_.size());
 
     if (!body_.empty())
         sink.write_bytes(body_);
@@ -139,6 +278,49 @@ void object_payload::to_data(uint32_t version, writer& sink) const
     pow_.to_data(version, sink);
 }
 
+size_t object_payload::compact_size(uint32_t version) const
+{
+    return 1 + message::variable_uint_size(body_size_)
+            + (compressed_ ? message::variable_uint_size(body_.size()) : 0) + body_.size()
+            + (body_.empty() ? body_id_.serialized_size(version) : 0)
+            + pow_.serialized_size(version);
+}
+
+bool object_payload::compress()
+{
+    if (compressed_ || body_.empty())
+        return compressed_;
+
+    // Ids are those of the plain body.
+    get_body_id();
+    get_id();
+
+    auto deflated = deflate(body_);
+    if (deflated.size() + message::variable_uint_size(deflated.size()) >= body_.size())
+        return false;
+
+    body_ = std::move(deflated);
+    body_.shrink_to_fit();
+    compressed_ = true;
+    return true;
+}
+
+bool object_payload::is_compressed() const
+{
+    return compressed_;
+}
+
+data_chunk object_payload::body() const
+{
+    if (!compressed_)
+        return body_;
+
+    // Checked when the body was compressed or received.
+    data_chunk plain;
+    inflate(body_, body_size_, plain);
+    return plain;
+}
+
 bool object_payload::is_valid() const
 {
     return ((body_.empty() && !body_id_.empty()) || !body_.empty()) && body_id_.is_valid() && pow_.is_valid();
@@ -146,14 +328,17 @@ bool object_payload::is_valid() const
 
 size_t object_payload::serialized_size(uint32_t version) const
 {
-    return message::variable_uint_size(body_.size()) + body_.size()
+    return message::variable_uint_size(body_size_) + body_size_
             + (body_.empty() ? body_id_.serialized_size(version) : 0)
             + pow_.serialized_size(version);
 }
 
 object_payload& object_payload::operator=(object_payload&& other)
 {
+    validation = other.validation;
     body_ = std::move(other.body_);
+    body_size_ = other.body_size_;
+    compressed_ = other.compressed_;
     body_id_ = std::move(other.body_id_);
     pow_ = std::move(other.pow_);
     return *this;
@@ -161,7 +346,10 @@ object_payload& object_payload::operator=(object_payload&& other)
 
 bool object_payload::operator==(const object_payload& other) const
 {
-    return (body_ == other.body_) && (body_id_ == other.body_id_) && (pow_ == other.pow_);
+    const auto same_body = compressed_ == other.compressed_ ?
+        body_ == other.body_ : body() == other.body();
+
+    return same_body && (body_id_ == other.body_id_) && (pow_ == other.pow_);
 }
 
 bool object_payload::operator!=(const object_payload& other) const
@@ -186,7 +374,7 @@ multihash object_payload::get_body_id()
     BITCOIN_ASSERT(is_valid());
     if (body_id_.empty())
     {
-        multihash mh(digest_type::sha2_256, sha256_hash_chunk(body_));
+        multihash mh(digest_type::sha2_256, sha256_hash_chunk(body()));
         body_id_ = std::move(mh);
     }
 
@@ -231,7 +419,7 @@ uint256_t object_payload::get_pow_value()
 std::string object_payload::to_string() const
 {
     std::stringstream stream;
-    stream << "{body_=" << bc::encode_base16(body_)
+    stream << "{body_=" << bc::encode_base16(body())
            << " id_=" << body_id_.to_string()
            << " pow_=" << pow_.to_string()
            << "}";
@@ -305,8 +493,8 @@ void object::reset()
 
 bool object::from_data(uint32_t version, const data_chunk& data)
 {
-    data_source istream(data);
-    return from_data(version, istream);
+    span_reader source(data);
+    return from_data(version, source);
 }
 
 bool object::from_data(uint32_t version, std::istream& stream)
@@ -371,5 +559,76 @@ bool object::operator!=(const object& other) const
     return !(*this == other);
 }
 
+const std::string compressed_object::command = "cobject";
+const uint32_t compressed_object::version_minimum = version::level::minimum;
+const uint32_t compressed_object::version_maximum = version::level::maximum;
+
+compressed_object::compressed_object()
+  : object()
+{
+}
+
+compressed_object::compressed_object(const object_payload& payload)
+  : object(payload)
+{
+}
+
+compressed_object::compressed_object(object_payload&& payload)
+  : object(std::move(payload))
+{
+}
+
+bool compressed_object::from_data(uint32_t version, const data_chunk& data)
+{
+    span_reader source(data);
+    return from_data(version, source);
+}
+
+bool compressed_object::from_data(uint32_t version, std::istream& stream)
+{
+    istream_reader source(stream);
+    return from_data(version, source);
+}
+
+bool compressed_object::from_data(uint32_t version, reader& source)
+{
+    reset();
+
+    payload_.from_compact_data(version, source);
+
+    if (!source)
+        reset();
+
+    return source;
+}
+
+data_chunk compressed_object::to_data(uint32_t version) const
+{
+    data_chunk data;
+    const auto size = serialized_size(version);
+    data.reserve(size);
+    data_sink ostream(data);
+    to_data(version, ostream);
+    ostream.flush();
+    BITCOIN_ASSERT(data.size() == size);
+    return data;
+}
+
+void compressed_object::to_data(uint32_t version, std::ostream& stream) const
+{
+    ostream_writer sink(stream);
+    to_data(version, sink);
+}
+
+void compressed_object::to_data(uint32_t version, writer& sink) const
+{
+    payload_.to_compact_data(version, sink);
+}
+
+size_t compressed_object::serialized_size(uint32_t version) const
+{
+    return payload_.compact_size(version);
+}
+
 } // namespace message
 } // namespace libbitcoin
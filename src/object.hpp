@@ -68,6 +68,19 @@ public:
     void reset();
     size_t serialized_size(uint32_t version) const;
 
+    /// Compact encoding, the body as it is kept (see compressed_object).
+    bool from_compact_data(uint32_t version, reader& source);
+    void to_compact_data(uint32_t version, writer& sink) const;
+    size_t compact_size(uint32_t version) const;
+
+    /// Keep the body zlib compressed if that makes it smaller. Ids, PoW and
+    /// the plain encoding are those of the uncompressed body.
+    bool compress();
+    bool is_compressed() const;
+
+    /// Uncompressed body.
+    data_chunk body() const;
+
     /// This class is move assignable but not copy assignable.
     object_payload& operator=(object_payload&& other);
     void operator=(const object_payload&) = delete;
@@ -85,6 +98,11 @@ public:
         return pow_.get_pow_type();
     }
 
+    inline const pow_algorithm* get_pow_algorithm() const
+    {
+        return pow_.get_pow_algorithm();
+    }
+
     inline hash_digest get_anchor() const
     {
         return pow_.get_anchor();
@@ -104,7 +122,11 @@ public:
 protected:
 
 private:
-    data_chunk body_;     // empty in case of pure PoW (empty pin)
+    void to_data(uint32_t version, writer& sink, const data_chunk& body) const;
+
+    data_chunk body_;     // empty in case of pure PoW (empty pin), zlib stream if compressed_
+    size_t body_size_;    // uncompressed
+    bool compressed_;
     multihash body_id_;        // empty in wire format in case !body_.empty()
 
     pow_certificate pow_;
@@ -153,10 +175,39 @@ public:
     static const uint32_t version_minimum;
     static const uint32_t version_maximum;
 
-private:
+protected:
     object_payload payload_;
 };
 
+/**
+ * An object in the compact encoding, sent to peers which advertise the
+ * compression service bit. A flags byte precedes the payload and the body
+ * may be zlib compressed. It is received as an object.
+ */
+class BC_API compressed_object
+  : public object
+{
+public:
+    typedef std::shared_ptr<compressed_object> ptr;
+    typedef std::shared_ptr<const compressed_object> const_ptr;
+
+    compressed_object();
+    compressed_object(const object_payload& payload);
+    compressed_object(object_payload&& payload);
+
+    bool from_data(uint32_t version, const data_chunk& data);
+    bool from_data(uint32_t version, std::istream& stream);
+    bool from_data(uint32_t version, reader& source);
+    data_chunk to_data(uint32_t version) const;
+    void to_data(uint32_t version, std::ostream& stream) const;
+    void to_data(uint32_t version, writer& sink) const;
+    size_t serialized_size(uint32_t version) const;
+
+    static const std::string command;
+    static const uint32_t version_minimum;
+    static const uint32_t version_maximum;
+};
+
 } // namespace message
 
 #define DECLARE_MESSAGE_POINTER_TYPES(type) \
@@ -164,6 +215,7 @@ typedef message::type::ptr type##_ptr; \
 typedef message::type::const_ptr type##_const_ptr
 
 DECLARE_MESSAGE_POINTER_TYPES(object);
+DECLARE_MESSAGE_POINTER_TYPES(compressed_object);
 
 #undef DECLARE_MESSAGE_POINTER_TYPE
 
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <utility>
+
+#include <bitcoin/bitcoin/constants.hpp>
+#include <bitcoin/bitcoin/message/messages.hpp>
+#include <bitcoin/bitcoin/message/version.hpp>
+#include <bitcoin/bitcoin/utility/assert.hpp>
+#include <bitcoin/bitcoin/utility/container_sink.hpp>
+#include <bitcoin/bitcoin/utility/container_source.hpp>
+#include <bitcoin/bitcoin/utility/istream_reader.hpp>
+#include <bitcoin/bitcoin/utility/ostream_writer.hpp>
+
+#include "object_inventory.hpp"
+#include "span_reader.hpp"
+
+namespace libbitcoin {
+namespace message {
+
+// object_inventory
+// ----------------------------------------------------------------------------
+
+const std::string object_inventory::command = "objinv";
+const uint32_t object_inventory::version_minimum = version::level::minimum;
+const uint32_t object_inventory::version_maximum = version::level::maximum;
+
+object_inventory object_inventory::factory_from_data(uint32_t version, const data_chunk& data)
+{
+    object_inventory instance;
+    instance.from_data(version, data);
+    return instance;
+}
+
+object_inventory object_inventory::factory_from_data(uint32_t version, std::istream& stream)
+{
+    object_inventory instance;
+    instance.from_data(version, stream);
+    return instance;
+}
+
+object_inventory object_inventory::factory_from_data(uint32_t version, reader& source)
+{
+    object_inventory instance;
+    instance.from_data(version, source);
+    return instance;
+}
+
+object_inventory::object_inventory()
+  : ids_()
+{
+}
+
+object_inventory::object_inventory(const hash_list& ids)
+  : ids_(ids)
+{
+}
+
+object_inventory::object_inventory(hash_list&& ids)
+  : ids_(std::move(ids))
+{
+}
+
+hash_list& object_inventory::ids()
+{
+    return ids_;
+}
+
+const hash_list& object_inventory::ids() const
+{
+    return ids_;
+}
+
+void object_inventory::reset()
+{
+    ids_.clear();
+    ids_.shrink_to_fit();
+}
+
+bool object_inventory::is_valid() const
+{
+    return !ids_.empty();
+}
+
+bool object_inventory::from_data(uint32_t version, const data_chunk& data)
+{
+    span_reader source(data);
+    return from_data(version, source);
+}
+
+bool object_inventory::from_data(uint32_t version, std::istream& stream)
+{
+    istream_reader source(stream);
+    return from_data(version, source);
+}
+
+bool object_inventory::from_data(uint32_t version, reader& source)
+{
+    reset();
+
+    const auto count = source.read_size_little_endian();
+
+    // Guard against potential for arbitrary memory allocation.
+    if (count > max_inventory)
+        source.invalidate();
+    else
+        ids_.reserve(count);
+
+    for (size_t id = 0; id < count && source; ++id)
+        ids_.push_back(source.read_hash());
+
+    if (!source)
+        reset();
+
+    return source;
+}
+
+data_chunk object_inventory::to_data(uint32_t version) const
+{
+    data_chunk data;
+    const auto size = serialized_size(version);
+    data.reserve(size);
+    data_sink ostream(data);
+    to_data(version, ostream);
+    ostream.flush();
+    BITCOIN_ASSERT(data.size() == size);
+    return data;
+}
+
+void object_inventory::to_data(uint32_t version, std::ostream& stream) const
+{
+    ostream_writer sink(stream);
+    to_data(version, sink);
+}
+
+void object_inventory::to_data(uint32_t version, writer& sink) const
+{
+    sink.write_variable_little_endian(ids_.size());
+
+    for (const auto& id : ids_)
+        sink.write_hash(id);
+}
+
+size_t object_inventory::serialized_size(uint32_t version) const
+{
+    return variable_uint_size(ids_.size()) + ids_.size() * hash_size;
+}
+
+// get_objects
+// ----------------------------------------------------------------------------
+
+const std::string get_objects::command = "getobjects";
+const uint32_t get_objects::version_minimum = version::level::minimum;
+const uint32_t get_objects::version_maximum = version::level::maximum;
+
+get_objects get_objects::factory_from_data(uint32_t version, const data_chunk& data)
+{
+    get_objects instance;
+    instance.from_data(version, data);
+    return instance;
+}
+
+get_objects get_objects::factory_from_data(uint32_t version, std::istream& stream)
+{
+    get_objects instance;
+    instance.from_data(version, stream);
+    return instance;
+}
+
+get_objects get_objects::factory_from_data(uint32_t version, reader& source)
+{
+    get_objects instance;
+    instance.from_data(version, source);
+    return instance;
+}
+
+get_objects::get_objects()
+  : object_inventory()
+{
+}
+
+get_objects::get_objects(const hash_list& ids)
+  : object_inventory(ids)
+{
+}
+
+get_objects::get_objects(hash_list&& ids)
+  : object_inventory(std::move(ids))
+{
+}
+
+} // namespace message
+} // namespace libbitcoin
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_MESSAGE_OBJECT_INVENTORY_HPP
+#define LIBBITCOIN_MESSAGE_OBJECT_INVENTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include <bitcoin/bitcoin/define.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+#include <bitcoin/bitcoin/utility/data.hpp>
+#include <bitcoin/bitcoin/utility/reader.hpp>
+#include <bitcoin/bitcoin/utility/writer.hpp>
+
+namespace libbitcoin {
+namespace message {
+
+/**
+ * Announcement of pinboard objects by id. Peers lacking an object ask for
+ * its body with get_objects instead of receiving it unsolicited.
+ */
+class BC_API object_inventory
+{
+public:
+    typedef std::shared_ptr<object_inventory> ptr;
+    typedef std::shared_ptr<const object_inventory> const_ptr;
+
+    static object_inventory factory_from_data(uint32_t version, const data_chunk& data);
+    static object_inventory factory_from_data(uint32_t version, std::istream& stream);
+    static object_inventory factory_from_data(uint32_t version, reader& source);
+
+    object_inventory();
+    object_inventory(const hash_list& ids);
+    object_inventory(hash_list&& ids);
+
+    hash_list& ids();
+    const hash_list& ids() const;
+
+    bool from_data(uint32_t version, const data_chunk& data);
+    bool from_data(uint32_t version, std::istream& stream);
+    bool from_data(uint32_t version, reader& source);
+    data_chunk to_data(uint32_t version) const;
+    void to_data(uint32_t version, std::ostream& stream) const;
+    void to_data(uint32_t version, writer& sink) const;
+    bool is_valid() const;
+    void reset();
+    size_t serialized_size(uint32_t version) const;
+
+    static const std::string command;
+    static const uint32_t version_minimum;
+    static const uint32_t version_maximum;
+
+private:
+    hash_list ids_;
+};
+
+/// Request of the pinboard objects with the given ids.
+class BC_API get_objects
+  : public object_inventory
+{
+public:
+    typedef std::shared_ptr<get_objects> ptr;
+    typedef std::shared_ptr<const get_objects> const_ptr;
+
+    static get_objects factory_from_data(uint32_t version, const data_chunk& data);
+    static get_objects factory_from_data(uint32_t version, std::istream& stream);
+    static get_objects factory_from_data(uint32_t version, reader& source);
+
+    get_objects();
+    get_objects(const hash_list& ids);
+    get_objects(hash_list&& ids);
+
+    static const std::string command;
+    static const uint32_t version_minimum;
+    static const uint32_t version_maximum;
+};
+
+} // namespace message
+
+typedef message::object_inventory::const_ptr object_inventory_const_ptr;
+typedef message::get_objects::const_ptr get_objects_const_ptr;
+
+} // namespace libbitcoin
+
+#endif
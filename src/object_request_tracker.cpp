@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "object_request_tracker.hpp"
+
+#include <algorithm>
+
+namespace libbitcoin {
+namespace node {
+
+object_request_tracker::object_request_tracker(const clock::duration& timeout,
+                                               size_t max_in_flight,
+                                               size_t max_announced,
+                                               size_t max_pending)
+  : timeout_(timeout), max_in_flight_(max_in_flight), max_announced_(max_announced),
+    max_pending_(max_pending), pending_(0)
+{
+}
+
+bool object_request_tracker::announce(const hash_digest& id, const config::authority& peer)
+{
+    const auto now = clock::now();
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+
+    const auto& counts = load(peer);
+    if (counts.announced >= max_announced_)
+        return false;
+
+    const auto it = requests_.find(id);
+    if (it != requests_.end())
+    {
+        add_announcer(it->second, peer);
+        return false;
+    }
+
+    // Over its share the peer gets the request on a later tick, if there
+    // is room for it to wait.
+    const auto wait = counts.in_flight >= max_in_flight_;
+    if (wait && pending_ >= max_pending_)
+        return false;
+
+    auto& entry = requests_[id];
+    pending_++;
+    add_announcer(entry, peer);
+
+    if (wait)
+        return false;
+
+    assign(entry, peer, now);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+hash_list object_request_tracker::take_over(const config::authority& peer)
+{
+    const auto now = clock::now();
+    hash_list ids;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+
+    for (auto it = requests_.begin(); it != requests_.end() && load(peer).in_flight < max_in_flight_;)
+    {
+        auto& entry = it->second;
+
+        if (entry.expiry > now || entry.peer == peer)
+        {
+            ++it;
+            continue;
+        }
+
+        // The previous peer did not deliver, don't ask it again.
+        if (entry.expiry != clock::time_point())
+        {
+            remove_announcer(entry, entry.peer);
+            unassign(entry);
+        }
+
+        if (entry.announcers.empty())
+        {
+            it = erase(it);
+            continue;
+        }
+
+        const auto& announcers = entry.announcers;
+        if (std::find(announcers.begin(), announcers.end(), peer) != announcers.end())
+        {
+            assign(entry, peer, now);
+            ids.push_back(it->first);
+        }
+
+        ++it;
+    }
+
+    return ids;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool object_request_tracker::received(const hash_digest& id,
+    const config::authority& peer, clock::duration& latency)
+{
+    const auto now = clock::now();
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+
+    const auto it = requests_.find(id);
+    if (it == requests_.end())
+        return false;
+
+    auto& entry = it->second;
+    const auto requested = entry.expiry != clock::time_point() &&
+        entry.peer == peer;
+
+    if (requested)
+        latency = now - (entry.expiry - timeout_);
+
+    erase(it);
+    return requested;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void object_request_tracker::release(const config::authority& peer)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+
+    for (auto it = requests_.begin(); it != requests_.end();)
+    {
+        auto& entry = it->second;
+        remove_announcer(entry, peer);
+
+        if (entry.peer == peer)
+            unassign(entry);
+
+        if (entry.announcers.empty())
+            it = erase(it);
+        else
+            ++it;
+    }
+
+    loads_.erase(std::remove_if(loads_.begin(), loads_.end(),
+        [&peer](const load_list::value_type& value) { return value.first == peer; }), loads_.end());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t object_request_tracker::in_flight() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+
+    size_t count = 0;
+    for (const auto& value : loads_)
+        count += value.second.in_flight;
+
+    return count;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+object_request_tracker::peer_load& object_request_tracker::load(const config::authority& peer)
+{
+    for (auto& value : loads_)
+        if (value.first == peer)
+            return value.second;
+
+    loads_.emplace_back(peer, peer_load{ 0, 0 });
+    return loads_.back().second;
+}
+
+// private
+void object_request_tracker::assign(request& entry, const config::authority& peer,
+                                    const clock::time_point& now)
+{
+    entry.peer = peer;
+    entry.expiry = now + timeout_;
+    load(peer).in_flight++;
+    pending_--;
+}
+
+// private
+// An unassigned request has the epoch as expiry, any announcer may take it.
+void object_request_tracker::unassign(request& entry)
+{
+    if (entry.expiry == clock::time_point())
+        return;
+
+    auto& count = load(entry.peer).in_flight;
+    if (count > 0)
+        count--;
+
+    entry.peer = config::authority();
+    entry.expiry = clock::time_point();
+    pending_++;
+}
+
+// private
+void object_request_tracker::add_announcer(request& entry, const config::authority& peer)
+{
+    auto& announcers = entry.announcers;
+    if (std::find(announcers.begin(), announcers.end(), peer) != announcers.end())
+        return;
+
+    announcers.push_back(peer);
+    load(peer).announced++;
+}
+
+// private
+void object_request_tracker::remove_announcer(request& entry, const config::authority& peer)
+{
+    auto& announcers = entry.announcers;
+    const auto it = std::find(announcers.begin(), announcers.end(), peer);
+    if (it == announcers.end())
+        return;
+
+    announcers.erase(it);
+    auto& count = load(peer).announced;
+    if (count > 0)
+        count--;
+}
+
+// private
+object_request_tracker::request_map::iterator object_request_tracker::erase(request_map::iterator it)
+{
+    auto& entry = it->second;
+    unassign(entry);
+    pending_--;
+
+    for (const auto& peer : entry.announcers)
+    {
+        auto& count = load(peer).announced;
+        if (count > 0)
+            count--;
+    }
+
+    return requests_.erase(it);
+}
+
+} // namespace node
+} // namespace libbitcoin
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NODE_OBJECT_REQUEST_TRACKER_HPP
+#define LIBBITCOIN_NODE_OBJECT_REQUEST_TRACKER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+#include <bitcoin/bitcoin/config/authority.hpp>
+
+namespace libbitcoin {
+namespace node {
+
+/**
+ * Node wide record of pinboard objects announced by peers and requested
+ * with get_objects, thread safe.
+ *
+ * An object is requested from one announcer at a time. When that peer does
+ * not deliver within the timeout or goes away, the next tick of another
+ * announcer takes the request over.
+ *
+ * Announcements are dropped once the peer has announced max_announced ids
+ * still tracked, or once max_pending ids wait for a request, so a peer
+ * can't grow the record faster than requests drain it.
+ */
+class object_request_tracker
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    object_request_tracker(const clock::duration& timeout, size_t max_in_flight,
+        size_t max_announced, size_t max_pending);
+
+    /// Peer announced id, true if peer should request it now.
+    bool announce(const hash_digest& id, const config::authority& peer);
+
+    /// Ids announced by peer whose request is not in flight any more,
+    /// they are now in flight with peer.
+    hash_list take_over(const config::authority& peer);
+
+    /// The object arrived (or was rejected), from whichever peer. True if
+    /// it was in flight with peer, latency is then the time since the
+    /// request was sent.
+    bool received(const hash_digest& id, const config::authority& peer,
+        clock::duration& latency);
+
+    /// The peer went away, its requests are to be taken over.
+    void release(const config::authority& peer);
+
+    size_t in_flight() const;
+
+private:
+    struct request
+    {
+        config::authority peer;
+        clock::time_point expiry;
+        std::vector<config::authority> announcers;
+    };
+
+    struct peer_load
+    {
+        size_t in_flight;
+        size_t announced;       // tracked ids among the announcements
+    };
+
+    typedef std::map<hash_digest, request> request_map;
+    typedef std::vector<std::pair<config::authority, peer_load>> load_list;
+
+    // Require the lock.
+    peer_load& load(const config::authority& peer);
+    void assign(request& entry, const config::authority& peer, const clock::time_point& now);
+    void unassign(request& entry);
+    void add_announcer(request& entry, const config::authority& peer);
+    void remove_announcer(request& entry, const config::authority& peer);
+    request_map::iterator erase(request_map::iterator it);
+
+    const clock::duration timeout_;
+    const size_t max_in_flight_;
+    const size_t max_announced_;
+    const size_t max_pending_;
+
+    // -------------------------------------------------------------------------
+    mutable upgrade_mutex mutex_;
+    request_map requests_;
+    size_t pending_;            // requests not in flight
+    load_list loads_;
+    // -------------------------------------------------------------------------
+};
+
+} // namespace node
+} // namespace libbitcoin
+
+#endif
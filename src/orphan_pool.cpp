@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "orphan_pool.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+orphan_pool::orphan_pool(size_t capacity, const clock::duration& max_age)
+  : capacity_(capacity), max_age_(max_age)
+{
+}
+
+size_t orphan_pool::size() const
+{
+    return hashes_.size();
+}
+
+bool orphan_pool::contains(const hash_digest& hash) const
+{
+    return hashes_.find(hash) != hashes_.end();
+}
+
+bool orphan_pool::add(const header_record& unlinked)
+{
+    const auto now = clock::now();
+    expire(now);
+
+    if (capacity_ == 0 || !hashes_.insert(unlinked.hash()).second)
+        return false;
+
+    const auto parent = unlinked.previous_block_hash();
+    by_parent_.emplace(parent, unlinked);
+    arrivals_.push_back(arrival{ now, parent, unlinked.hash() });
+
+    // Make room by dropping the oldest arrivals.
+    while (hashes_.size() > capacity_)
+    {
+        const auto oldest = arrivals_.front();
+        arrivals_.pop_front();
+        erase(oldest.parent, oldest.hash);
+    }
+
+    return true;
+}
+
+std::vector<header_record> orphan_pool::take_children(const hash_digest& parent)
+{
+    std::vector<header_record> children;
+    const auto range = by_parent_.equal_range(parent);
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        hashes_.erase(it->second.hash());
+        children.push_back(it->second);
+    }
+
+    by_parent_.erase(range.first, range.second);
+
+    // Drop the arrivals of connected headers once nothing older is pooled.
+    while (!arrivals_.empty() && !contains(arrivals_.front().hash))
+        arrivals_.pop_front();
+
+    return children;
+}
+
+// private
+void orphan_pool::expire(const clock::time_point& now)
+{
+    while (!arrivals_.empty() && now - arrivals_.front().time > max_age_)
+    {
+        const auto oldest = arrivals_.front();
+        arrivals_.pop_front();
+        erase(oldest.parent, oldest.hash);
+    }
+}
+
+// private
+bool orphan_pool::erase(const hash_digest& parent, const hash_digest& hash)
+{
+    if (hashes_.erase(hash) == 0)
+        return false;
+
+    const auto range = by_parent_.equal_range(parent);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.hash() == hash)
+        {
+            by_parent_.erase(it);
+            break;
+        }
+    }
+
+    return true;
+}
+
+} // namespace chain
+} // namespace libbitcoin
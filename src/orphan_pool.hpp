@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CHAIN_ORPHAN_POOL_HPP
+#define LIBBITCOIN_CHAIN_ORPHAN_POOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <bitcoin/bitcoin/math/hash.hpp>
+
+#include "header_record.hpp"
+
+namespace libbitcoin {
+namespace chain {
+
+/**
+ * Headers whose parent is not known yet, indexed by parent hash, not thread
+ * safe. The pool holds at most capacity headers for at most max_age, the
+ * oldest arrivals are evicted first.
+ */
+class orphan_pool
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    orphan_pool(size_t capacity, const clock::duration& max_age);
+
+    size_t size() const;
+    bool contains(const hash_digest& hash) const;
+
+    /// Store an unlinked record, false if it is already pooled.
+    bool add(const header_record& unlinked);
+
+    /// Remove and return the headers whose parent is parent.
+    std::vector<header_record> take_children(const hash_digest& parent);
+
+private:
+    struct arrival
+    {
+        clock::time_point time;
+        hash_digest parent;
+        hash_digest hash;
+    };
+
+    void expire(const clock::time_point& now);
+    bool erase(const hash_digest& parent, const hash_digest& hash);
+
+    const size_t capacity_;
+    const clock::duration max_age_;
+
+    std::multimap<hash_digest, header_record> by_parent_;
+    std::set<hash_digest> hashes_;
+
+    // Arrival order, entries of connected headers are skipped lazily.
+    std::deque<arrival> arrivals_;
+};
+
+} // namespace chain
+} // namespace libbitcoin
+
+#endif
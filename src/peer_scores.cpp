@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "peer_scores.hpp"
+
+#include <algorithm>
+
+namespace libbitcoin {
+namespace node {
+
+// Assumed for a peer until it is measured.
+static const double prior_rtt_ms = 500;
+static const double prior_delivery_ms = 1000;
+
+// Weight of a new sample in the moving averages.
+static const double sample_weight = 0.2;
+
+static double average(double current, double sample)
+{
+    return current + sample_weight * (sample - current);
+}
+
+static double milliseconds(const peer_scores::clock::duration& value)
+{
+    return std::chrono::duration<double, std::milli>(value).count();
+}
+
+peer_scores::peer_scores(size_t capacity)
+  : capacity_(std::max(capacity, size_t(1)))
+{
+}
+
+void peer_scores::round_trip(const config::authority& peer, const clock::duration& rtt)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+    auto& value = find(peer);
+    value.rtt_ms = average(value.rtt_ms, milliseconds(rtt));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void peer_scores::delivered(const config::authority& peer, const clock::duration& latency)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+    auto& value = find(peer);
+    value.delivery_ms = average(value.delivery_ms, milliseconds(latency));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void peer_scores::received(const config::authority& peer, bool useful)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    unique_lock lock(mutex_);
+    auto& value = find(peer);
+
+    // Halve the counts now and then, recent behaviour matters most.
+    if (value.total == 1024)
+    {
+        value.total /= 2;
+        value.useful /= 2;
+    }
+
+    value.total++;
+    if (useful)
+        value.useful++;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+double peer_scores::score(const config::authority& peer) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+
+    const auto it = peers_.find(peer.to_string());
+    if (it != peers_.end())
+        return score(it->second);
+
+    static const stats unknown{ prior_rtt_ms, prior_delivery_ms, 0, 0, {} };
+    return score(unknown);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// static
+double peer_scores::score(const stats& value)
+{
+    // Laplace smoothed, a peer without objects yet counts as half useful.
+    const auto useful = (value.useful + 1.0) / (value.total + 2.0);
+    return (value.rtt_ms + value.delivery_ms) / useful;
+}
+
+// private
+peer_scores::stats& peer_scores::find(const config::authority& peer)
+{
+    const auto now = clock::now();
+    const auto key = peer.to_string();
+
+    auto it = peers_.find(key);
+    if (it == peers_.end())
+    {
+        // Forget the peer heard from least recently.
+        if (peers_.size() >= capacity_)
+            peers_.erase(std::min_element(peers_.begin(), peers_.end(),
+                [](const stats_map::value_type& left, const stats_map::value_type& right)
+                {
+                    return left.second.seen < right.second.seen;
+                }));
+
+        it = peers_.emplace(key, stats{ prior_rtt_ms, prior_delivery_ms, 0, 0, now }).first;
+    }
+
+    it->second.seen = now;
+    return it->second;
+}
+
+} // namespace node
+} // namespace libbitcoin
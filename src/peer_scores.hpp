@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NODE_PEER_SCORES_HPP
+#define LIBBITCOIN_NODE_PEER_SCORES_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/bitcoin/config/authority.hpp>
+
+namespace libbitcoin {
+namespace node {
+
+/**
+ * Node wide record of how well pinboard peers serve us, thread safe.
+ *
+ * Per peer it keeps moving averages of the get_headers round trip and of
+ * the time from get_objects to the object, and how many of the objects
+ * received were new. The score is the expected latency divided by the
+ * useful ratio, lower is better. Peers never seen score as the priors,
+ * so they compete with known ones rather than being ignored.
+ */
+class peer_scores
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    explicit peer_scores(size_t capacity);
+
+    /// A request answered after rtt.
+    void round_trip(const config::authority& peer, const clock::duration& rtt);
+
+    /// A requested object delivered after latency.
+    void delivered(const config::authority& peer, const clock::duration& latency);
+
+    /// An object received, useful if it was new and accepted.
+    void received(const config::authority& peer, bool useful);
+
+    double score(const config::authority& peer) const;
+
+private:
+    struct stats
+    {
+        double rtt_ms;
+        double delivery_ms;
+        uint32_t useful;
+        uint32_t total;
+        clock::time_point seen;
+    };
+
+    typedef std::unordered_map<std::string, stats> stats_map;
+
+    static double score(const stats& value);
+
+    // Requires the lock.
+    stats& find(const config::authority& peer);
+
+    const size_t capacity_;
+
+    // -------------------------------------------------------------------------
+    mutable upgrade_mutex mutex_;
+    stats_map peers_;
+    // -------------------------------------------------------------------------
+};
+
+} // namespace node
+} // namespace libbitcoin
+
+#endif
@@ -50,7 +50,8 @@ code pinboard::process(object_const_ptr obj, result_handler handler)
 
     hash_digest id = op.get_id();
 
-    if (op.get_pow_type() != default_pow::type())
+    const pow_algorithm* algorithm = op.get_pow_algorithm();
+    if (algorithm == nullptr)
     {
         LOG_ERROR(LOG_PINBOARD) << "Incorrect PoW type " << (size_t)op.get_pow_type()
                                   << " in object " << bc::encode_base16(id)
@@ -58,7 +59,6 @@ code pinboard::process(object_const_ptr obj, result_handler handler)
         return error::invalid_proof_of_work;
     }
 
-
     uint256_t work_done = op.get_work_done();
     size_t size = op.serialized_size(0);
 
@@ -66,38 +66,52 @@ code pinboard::process(object_const_ptr obj, result_handler handler)
                              << " size = " << size
                              << " work = " << work_done;
 
-    if (op.get_pow_value() > MIN_TARGET)
+    if (op.get_pow_value() > algorithm->equivalent_target(min_target_))
     {
-        LOG_ERROR(LOG_PINBOARD) << "PoW is below MIN_TARGET for object " << bc::encode_base16(id)
+        LOG_ERROR(LOG_PINBOARD) << "PoW is below the minimum target for object " << bc::encode_base16(id)
                                   << ". Rejecting.";
         return error::invalid_proof_of_work;
     }
 
     const hash_digest anchor = op.get_anchor();
-    chain::lite_header header;
+    const auto snapshot = chain_state_->get_snapshot();
+    const auto header = snapshot->find(anchor);
+
+    if (header == nullptr)
+    {
+        LOG_WARNING(LOG_PINBOARD) << "Anchor with id = " << bc::encode_base16(anchor) << " isn't known or is too old";
+        return error::unknown;
+    }
 
-    if (!chain_state_->get_header_by_id(anchor, header))
+    // The reorganization hook only evicts objects when the main chain moves,
+    // an anchor already off it would never be looked at again.
+    if (!snapshot->is_main(anchor))
     {
-        LOG_WARNING(LOG_PINBOARD) << "Anchor with id = " << bc::encode_base16(anchor) << " isn't known";
+        LOG_WARNING(LOG_PINBOARD) << "Anchor with id = " << bc::encode_base16(anchor) << " isn't on the main chain";
         return error::unknown;
     }
 
-    uint32_t ttl = calc_ttl(work_done, size);
+    const uint32_t anchor_timestamp = header->timestamp;
+
+    uint32_t ttl = calc_ttl(work_done, size, algorithm->cost);
     uint32_t now = static_cast<uint32_t>(time(nullptr));
 
-    LOG_INFO(LOG_PINBOARD) << "TTL = " << ttl << " sec since " << header.timestamp() << " now = " << now;
-    LOG_INFO(LOG_PINBOARD) << "SAVE UNTIL = " << (header.timestamp() + ttl);
+    LOG_INFO(LOG_PINBOARD) << "TTL = " << ttl << " sec since " << anchor_timestamp << " now = " << now;
+    LOG_INFO(LOG_PINBOARD) << "SAVE UNTIL = " << (anchor_timestamp + ttl);
 
-    if (now >= (header.timestamp() + ttl))
+    if (now >= (anchor_timestamp + ttl))
     {
         LOG_WARNING(LOG_PINBOARD) << "Object " << bc::encode_base16(id) << " is "
-                                    << (now - (header.timestamp() + ttl)) << " seconds old. Rejecting.";
+                                    << (now - (anchor_timestamp + ttl)) << " seconds old. Rejecting.";
         return error::unknown;
     }
 
-    LOG_INFO(LOG_PINBOARD) << "TTL = " << (header.timestamp() + ttl - now) << " seconds more";
+    LOG_INFO(LOG_PINBOARD) << "TTL = " << (anchor_timestamp + ttl - now) << " seconds more";
+
+    // Text compresses well, it's kept and served to peers that way.
+    op.compress();
 
-    object_details details(move(op), calc_bucket_id(header.timestamp() + ttl), header.timestamp(), ttl);
+    object_details details(move(op), calc_bucket_id(anchor_timestamp + ttl), anchor_timestamp, ttl);
 
     LOG_INFO(LOG_PINBOARD) << "BUCKET ID = " << details.bucket_id_ << " " << hex << details.bucket_id_ << dec;
 
@@ -123,14 +137,17 @@ code pinboard::process(object_const_ptr obj, result_handler handler)
             buckets_[details.bucket_id_].insert(id);
         }
 
+        anchors_[anchor].insert(id);
         objects_.emplace(id, move(details));
         ///////////////////////////////////////////////////////////////////////////
     }
 
-    broadcaster_->broadcast_to_pb(*(obj.get()),
+    // Announce the id, peers lacking the object ask for it.
+    const object_inventory announcement(hash_list{ id });
+    broadcaster_->broadcast_to_pb(announcement,
     [](const bc::code &errc, typename network::channel<network::message_subscriber_ex>::ptr channel)
     {
-        LOG_INFO(LOG_NETWORK) << "PINBOARD: broadcasted to [" << channel->authority() << "] with code " << errc;
+        LOG_INFO(LOG_NETWORK) << "PINBOARD: announced to [" << channel->authority() << "] with code " << errc;
     },
     [](const bc::code &errc)
     {
@@ -152,6 +169,18 @@ void pinboard::start(event_handler handler)
         handle_timer();
     });
 
+    chain_state_->subscribe_tip([this](const code& ec, const hash_digest& old_tip,
+                                       const hash_digest&, size_t reorg_depth)
+    {
+        if (ec)
+            return false;
+
+        if (reorg_depth > 0)
+            handle_reorganization(old_tip, reorg_depth);
+
+        return true;
+    });
+
     handler(error::success);
 }
 
@@ -182,9 +211,13 @@ threadpool& pinboard::pool()
     return threadpool_;
 }
 
-uint32_t pinboard::calc_ttl(const uint256_t &work_done, size_t size)
+// Seconds per byte for a unit of default_pow work, other types are weighted
+// by the cost of their hash so that TTL per unit of CPU is the same.
+static const uint32_t ttl_weight = 30;
+
+uint32_t pinboard::calc_ttl(const uint256_t &work_done, size_t size, uint32_t cost)
 {
-    uint256_t ttl = default_pow::pow_mul() * work_done / size;
+    uint256_t ttl = ttl_weight * cost * work_done / (size * default_pow::cost());
     if (ttl > (60 * 60 * 24))
         return (60 * 60 * 24);
     else
@@ -219,6 +252,59 @@ void pinboard::for_each(object_handler handler)
     ///////////////////////////////////////////////////////////////////////////
 }
 
+bool pinboard::contains(const hash_digest &id) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+    return objects_.find(id) != objects_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+hash_list pinboard::get_ids() const
+{
+    hash_list ids;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+
+    ids.reserve(objects_.size());
+    for (const auto &entry : objects_)
+        ids.push_back(entry.first);
+
+    return ids;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+id_sketch pinboard::get_sketch(size_t cells) const
+{
+    id_sketch sketch(cells);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+
+    for (const auto &entry : objects_)
+        sketch.insert(entry.first);
+
+    return sketch;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+object_const_ptr pinboard::get_object(const hash_digest &id) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::shared_lock lock(mutex_);
+    const auto iter = objects_.find(id);
+    if (iter == objects_.end())
+        return nullptr;
+
+    return make_shared<const object>(iter->second.object_);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 string pinboard::to_string() const
 {
     stringstream s;
@@ -279,6 +365,7 @@ void pinboard::cleanup()
             {
                 LOG_INFO(LOG_NETWORK) << "Deleting object with id "
                                       << bc::encode_base16(id) << " from bucket " << bucket.first;
+                remove_anchored(iter->second.object_.get_anchor(), id);
                 objects_.erase(iter);
             }
             else
@@ -297,5 +384,65 @@ void pinboard::cleanup()
     ///////////////////////////////////////////////////////////////////////////
 }
 
+void pinboard::handle_reorganization(const hash_digest &old_tip, size_t depth)
+{
+    const auto snapshot = chain_state_->get_snapshot();
+
+    // Headers above the fork point left the main chain, below it nothing
+    // changed. If the old tip is too old to tell, check every anchor.
+    const auto old_top = snapshot->find(old_tip);
+    const size_t fork_height = (old_top != nullptr && old_top->height >= depth) ? old_top->height - depth : 0;
+
+    size_t evicted = 0;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    bc::unique_lock lock(mutex_);
+
+    for (auto anchor = anchors_.begin(); anchor != anchors_.end();)
+    {
+        const auto header = snapshot->find(anchor->first);
+        if (header == nullptr || header->height <= fork_height || snapshot->is_main(anchor->first))
+        {
+            ++anchor;
+            continue;
+        }
+
+        for (const auto &id : anchor->second)
+        {
+            const auto iter = objects_.find(id);
+            if (iter == objects_.end())
+                continue;
+
+            const auto bucket = buckets_.find(iter->second.bucket_id_);
+            if (bucket != buckets_.end())
+            {
+                bucket->second.erase(id);
+                if (bucket->second.empty())
+                    buckets_.erase(bucket);
+            }
+
+            objects_.erase(iter);
+            evicted++;
+        }
+
+        anchor = anchors_.erase(anchor);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    LOG_INFO(LOG_PINBOARD) << "Reorganization of depth " << depth << " evicted " << evicted << " objects.";
+}
+
+void pinboard::remove_anchored(const hash_digest &anchor, const hash_digest &id)
+{
+    const auto iter = anchors_.find(anchor);
+    if (iter == anchors_.end())
+        return;
+
+    iter->second.erase(id);
+    if (iter->second.empty())
+        anchors_.erase(iter);
+}
+
+}
 }
-}
\ No newline at end of file
@@ -24,6 +24,7 @@
 
 #include "message_broadcaster.hpp"
 #include "chain_listener.hpp"
+#include "board_sketch.hpp"
 #include "object.hpp"
 
 #define LOG_PINBOARD "pinboard"
@@ -71,6 +72,7 @@ public:
     };
 
     typedef std::map<bc::hash_digest, object_details> hash_to_object_map;
+    typedef std::map<bc::hash_digest, std::set<bc::hash_digest>> anchor_map;
 
     typedef std::function<void(const code&)> event_handler;
     typedef std::function<void(const code&, object_const_ptr)> result_handler;
@@ -96,6 +98,15 @@ public:
     virtual code process(object_const_ptr obj, result_handler handler);
     void for_each(object_handler handler);
 
+    bool contains(const bc::hash_digest &id) const;
+    bc::hash_list get_ids() const;
+
+    /// Sketch of the ids of all stored objects, see board_sketch.
+    bc::message::id_sketch get_sketch(size_t cells) const;
+
+    /// Stored object with the given id, nullptr if unknown.
+    object_const_ptr get_object(const bc::hash_digest &id) const;
+
     /// Get the threadpool.
     virtual threadpool& pool();
 
@@ -110,7 +121,14 @@ protected:
 
     virtual void cleanup();
 
-    uint32_t calc_ttl(const uint256_t &work_done, size_t size);
+    // Evict the objects anchored on headers a reorganization took off the
+    // main chain.
+    void handle_reorganization(const bc::hash_digest &old_tip, size_t depth);
+
+    // Requires the lock.
+    void remove_anchored(const bc::hash_digest &anchor, const bc::hash_digest &id);
+
+    uint32_t calc_ttl(const uint256_t &work_done, size_t size, uint32_t cost);
     uint32_t calc_bucket_id(uint32_t ttl);
 
     message_broadcaster::ptr broadcaster_;
@@ -124,6 +142,7 @@ protected:
     mutable bc::upgrade_mutex mutex_;
     hash_to_object_map objects_;
     bucket_map buckets_;
+    anchor_map anchors_;
     // -------------------------------------------------------------------------
 };
 
@@ -0,0 +1,388 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+#include <boost/program_options.hpp>
+
+#include <bitcoin/bitcoin/utility/container_sink.hpp>
+#include <bitcoin/bitcoin/utility/ostream_writer.hpp>
+
+#include "chain_listener.hpp"
+#include "lite_header.hpp"
+#include "object.hpp"
+#include "pinboard.hpp"
+#include "pow_certificate.hpp"
+#include "config.hpp"
+
+using namespace std;
+using namespace boost::program_options;
+using namespace bc::chain;
+using namespace bc::message;
+using namespace bc::node;
+
+// Benchmarks for the hashing kernels and the PoW bookkeeping around them.
+// Every benchmark runs single-threaded and then on N threads, each thread
+// performing the same number of operations. Results go to stdout (or the
+// file given with --output) as JSON or CSV so that runs can be diffed.
+
+struct bench_options
+{
+    size_t threads = 1;
+    size_t iterations = 0;
+    string format = "json";
+    string output;
+};
+
+struct bench_result
+{
+    string name;
+    string params;
+    size_t threads = 0;
+    size_t ops = 0;
+    double seconds = 0;
+    double throughput = 0;   // operations per second, all threads
+    double mean_us = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+    double max_us = 0;
+};
+
+typedef function<void(size_t thread, size_t iteration)> bench_operation;
+
+// Exposes pinboard::calc_ttl, the rest of pinboard is left untouched.
+class bench_pinboard : public pinboard
+{
+public:
+    bench_pinboard(message_broadcaster::ptr broadcaster, chain_sync_state::ptr chain_state)
+        : pinboard(broadcaster, chain_state, MIN_TARGET)
+    {
+    }
+
+    using pinboard::calc_ttl;
+};
+
+static lite_header checkpoint_header(uint32_t nonce)
+{
+    bc::hash_digest prev_hash(bc::null_hash);
+    bc::hash_digest merkle_root(bc::null_hash);
+    bc::decode_hash(prev_hash, "d0a2824855062497a4b03c89b06def42abcb45158c406713cf219e5b4055a426");
+    bc::decode_hash(merkle_root, "e97314257cbd625676411a9c295861256c3932bae95312a0672d99711daf40d1");
+
+    lite_header h(536870912, prev_hash, merkle_root, 1514572031, 0x1a04865f, nonce);
+    h.validation.height = 1341188;
+    return h;
+}
+
+static object_payload make_object(size_t body_size, const bc::hash_digest& anchor, uint64_t nonce,
+                                  pow_type type = default_pow::type())
+{
+    const bc::data_chunk body(body_size, 'x');
+    const pow_certificate pow(type, chain_tag::litecoin_main, anchor, nonce);
+
+    bc::data_chunk data;
+    bc::data_sink ostream(data);
+    bc::ostream_writer sink(ostream);
+    sink.write_size_little_endian(body.size());
+    sink.write_bytes(body);
+    pow.to_data(0, sink);
+    ostream.flush();
+
+    return object_payload::factory_from_data(0, data);
+}
+
+static size_t peak_rss_kb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    // Linux reports kilobytes.
+    return static_cast<size_t>(usage.ru_maxrss);
+}
+
+static double percentile(const vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+
+    const auto index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+static bench_result run(const string& name, const string& params, size_t threads,
+                        size_t iterations, bench_operation operation)
+{
+    vector<vector<double>> latencies(threads);
+    vector<thread> workers;
+
+    const auto start = chrono::steady_clock::now();
+
+    for (size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([t, iterations, &latencies, &operation]()
+        {
+            auto& samples = latencies[t];
+            samples.reserve(iterations);
+
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const auto begin = chrono::steady_clock::now();
+                operation(t, i);
+                const auto end = chrono::steady_clock::now();
+                samples.push_back(chrono::duration<double, micro>(end - begin).count());
+            }
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    const auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> all;
+    for (const auto& samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+    sort(all.begin(), all.end());
+
+    bench_result result;
+    result.name = name;
+    result.params = params;
+    result.threads = threads;
+    result.ops = all.size();
+    result.seconds = elapsed;
+    result.throughput = elapsed > 0 ? all.size() / elapsed : 0;
+
+    double total = 0;
+    for (const auto l : all)
+        total += l;
+
+    result.mean_us = all.empty() ? 0 : total / all.size();
+    result.p50_us = percentile(all, 0.50);
+    result.p99_us = percentile(all, 0.99);
+    result.max_us = all.empty() ? 0 : all.back();
+
+    cerr << name << " [" << params << "] threads=" << threads
+         << " ops/s=" << result.throughput << " mean=" << result.mean_us << "us" << endl;
+
+    return result;
+}
+
+static void write_json(ostream& out, const vector<bench_result>& results, size_t rss_kb)
+{
+    out << "{" << endl;
+    out << "  \"peak_rss_kb\": " << rss_kb << "," << endl;
+    out << "  \"results\": [" << endl;
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto& r = results[i];
+        out << "    {\"benchmark\": \"" << r.name << "\""
+            << ", \"params\": \"" << r.params << "\""
+            << ", \"threads\": " << r.threads
+            << ", \"ops\": " << r.ops
+            << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_sec\": " << r.throughput
+            << ", \"latency_us\": {\"mean\": " << r.mean_us
+            << ", \"p50\": " << r.p50_us
+            << ", \"p99\": " << r.p99_us
+            << ", \"max\": " << r.max_us << "}}"
+            << (i + 1 < results.size() ? "," : "") << endl;
+    }
+
+    out << "  ]" << endl;
+    out << "}" << endl;
+}
+
+static void write_csv(ostream& out, const vector<bench_result>& results, size_t rss_kb)
+{
+    out << "benchmark,params,threads,ops,seconds,ops_per_sec,"
+        << "mean_us,p50_us,p99_us,max_us,peak_rss_kb" << endl;
+
+    for (const auto& r : results)
+        out << r.name << "," << r.params << "," << r.threads << "," << r.ops << ","
+            << r.seconds << "," << r.throughput << "," << r.mean_us << ","
+            << r.p50_us << "," << r.p99_us << "," << r.max_us << "," << rss_kb << endl;
+}
+
+static bench_options parse_bench_options(int argc, char* argv[])
+{
+    bench_options opt;
+    opt.threads = max(thread::hardware_concurrency(), 1u);
+
+    options_description commands{"Options"};
+    commands.add_options()
+            ("help,h", "This help message")
+            ("threads,t", value<size_t>(&opt.threads), "Number of threads for the parallel runs")
+            ("iterations,n", value<size_t>(&opt.iterations),
+             "Operations per thread (default depends on the benchmark)")
+            ("format,f", value<string>(&opt.format), "Output format: json or csv")
+            ("output,o", value<string>(&opt.output), "Write results to <arg> instead of stdout");
+
+    variables_map vm;
+    store(parse_command_line(argc, argv, commands), vm);
+    notify(vm);
+
+    if (vm.count("help"))
+    {
+        cout << "Usage: pinboard_bench [options]" << endl << endl << commands << endl;
+        exit(EXIT_SUCCESS);
+    }
+
+    if (opt.format != "json" && opt.format != "csv")
+    {
+        cerr << "Error: unknown format " << opt.format << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    opt.threads = max(opt.threads, size_t(1));
+    return opt;
+}
+
+int main(int argc, char* argv[])
+{
+    const auto opt = parse_bench_options(argc, argv);
+
+    // Slow kernels get fewer iterations unless overridden.
+    const auto slow = opt.iterations ? opt.iterations : 32;
+    const auto medium = opt.iterations ? opt.iterations : 2000;
+    const auto fast = opt.iterations ? opt.iterations : 200000;
+
+    const auto checkpoint = checkpoint_header(2046883480);
+    const auto anchor = checkpoint.hash();
+
+    auto broadcaster = make_shared<message_broadcaster>();
+    auto chain_state = make_shared<chain_sync_state>(broadcaster, checkpoint);
+    bench_pinboard board(broadcaster, chain_state);
+
+    vector<size_t> thread_counts{1};
+    if (opt.threads > 1)
+        thread_counts.push_back(opt.threads);
+
+    const vector<size_t> body_sizes{64, 1024, 16384};
+    const vector<pow_type> pow_types{pow_type::scrypt_14_1_8, pow_type::scrypt_10_1_1};
+
+    vector<bench_result> results;
+
+    for (const auto threads : thread_counts)
+    {
+        for (const auto size : body_sizes)
+        {
+            const auto blob = make_object(size, anchor, 0).serialize_id_and_pow();
+            stringstream params;
+            params << "blob=" << blob.size();
+
+            // Their ratio is the cost of pow_scrypt_14_1_8, see pow_certificate.hpp.
+            results.push_back(run("pow_scrypt_14_1_8::calculate", params.str(), threads, slow,
+                [&blob](size_t, size_t)
+                {
+                    pow_scrypt_14_1_8::calculate(blob);
+                }));
+
+            results.push_back(run("pow_scrypt_10_1_1::calculate", params.str(), threads, medium,
+                [&blob](size_t, size_t)
+                {
+                    pow_scrypt_10_1_1::calculate(blob);
+                }));
+        }
+
+        // A fresh header per operation, otherwise the cached hash is measured.
+        results.push_back(run("lite_header::pow_hash", "header=80", threads, medium,
+            [](size_t t, size_t i)
+            {
+                const auto header = checkpoint_header(static_cast<uint32_t>((t << 24) + i));
+                header.pow_hash();
+            }));
+
+        for (const auto type : pow_types)
+        {
+            for (const auto size : body_sizes)
+            {
+                const auto prototype = make_object(size, anchor, 0, type);
+                stringstream params;
+                params << "body=" << size << " pow=" << uint32_t(type);
+
+                // The prototype never computes its PoW, so neither does a copy.
+                results.push_back(run("object_payload::get_work_done", params.str(), threads,
+                    type == default_pow::type() ? slow : medium,
+                    [&prototype](size_t, size_t)
+                    {
+                        object_payload op(prototype);
+                        op.get_work_done();
+                    }));
+            }
+        }
+
+        for (const auto size : body_sizes)
+        {
+            const auto wire = make_object(size, anchor, 0).to_data(0);
+            stringstream params;
+            params << "body=" << size;
+
+            results.push_back(run("object_payload::from_data", params.str(), threads, fast,
+                [&wire](size_t, size_t)
+                {
+                    object_payload op;
+                    op.from_data(0, wire);
+                }));
+        }
+
+        for (const auto type : pow_types)
+        {
+            const auto cost = pow_algorithms::find(type)->cost;
+
+            for (const auto size : body_sizes)
+            {
+                stringstream params;
+                params << "size=" << size << " pow=" << uint32_t(type);
+
+                const bc::uint256_t target = MIN_TARGET;
+                const bc::uint256_t work = ((~target) / (target + 1)) + 1;
+
+                results.push_back(run("pinboard::calc_ttl", params.str(), threads, fast,
+                    [&board, &work, size, cost](size_t, size_t i)
+                    {
+                        board.calc_ttl(work + i, size, cost);
+                    }));
+            }
+        }
+    }
+
+    const auto rss = peak_rss_kb();
+
+    ofstream file;
+    if (!opt.output.empty())
+        file.open(opt.output);
+
+    ostream& out = opt.output.empty() ? cout : file;
+
+    if (opt.format == "csv")
+        write_csv(out, results, rss);
+    else
+        write_json(out, results, rss);
+
+    return 0;
+}
@@ -27,6 +27,7 @@
 #include <bitcoin/bitcoin/utility/ostream_writer.hpp>
 
 #include "pow_certificate.hpp"
+#include "span_reader.hpp"
 
 namespace libbitcoin {
 namespace message {
@@ -74,8 +75,8 @@ pow_certificate::pow_certificate(pow_type type, chain_tag tag, const hash_digest
 
 bool pow_certificate::from_data(uint32_t version, const data_chunk& data)
 {
-    data_source istream(data);
-    return from_data(version, istream);
+    span_reader source(data);
+    return from_data(version, source);
 }
 
 bool pow_certificate::from_data(uint32_t version, std::istream& stream)
@@ -168,7 +169,18 @@ uint256_t pow_certificate::calculate_work_done(const data_chunk &chunk)
 
 hash_digest pow_certificate::calculate_pow_hash(const data_chunk &chunk)
 {
-    return default_pow::calculate(to_pow_blob(chunk));
+    const auto algorithm = get_pow_algorithm();
+    BITCOIN_ASSERT(algorithm != nullptr);
+
+    if (algorithm == nullptr)
+    {
+        // The least possible work, callers are expected to reject the type first.
+        hash_digest worst;
+        worst.fill(0xfe);
+        return worst;
+    }
+
+    return algorithm->calculate(to_pow_blob(chunk));
 }
 
 data_chunk pow_certificate::to_pow_blob(const data_chunk &chunk) const
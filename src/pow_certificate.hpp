@@ -22,6 +22,7 @@
 #include <memory>
 #include <string>
 #include <bitcoin/bitcoin/define.hpp>
+#include <bitcoin/bitcoin/math/uint256.hpp>
 #include <bitcoin/bitcoin/utility/data.hpp>
 #include <bitcoin/bitcoin/utility/reader.hpp>
 #include <bitcoin/bitcoin/utility/writer.hpp>
@@ -39,16 +40,52 @@ enum class pow_type: uint32_t {
     max_pow_type
 };
 
-template<pow_type PT, uint32_t MUL, size_t SIZE, size_t N, size_t P, size_t R>
+/// Entry of the pow_type dispatch table, see pow_dispatch.
+struct pow_algorithm
+{
+    typedef hash_digest (*calculator)(const data_chunk& data);
+
+    pow_type type;
+    uint32_t cost;              // CPU cost of a hash, see pow_scrypt::cost
+    calculator calculate;       // nullptr if the type carries no PoW
+
+    /// The target of this type taking as much CPU to meet as target does
+    /// with default_pow.
+    uint256_t equivalent_target(const uint256_t& target) const;
+};
+
+class pow_plain
+{
+public:
+    static constexpr pow_type type()
+    {
+        return pow_type::plain;
+    }
+
+    static constexpr uint32_t cost()
+    {
+        return 0;
+    }
+
+    static constexpr pow_algorithm::calculator calculator()
+    {
+        return nullptr;
+    }
+};
+
+/// COST is the time of one hash in units of scrypt(N = 1024, r = 1, p = 1),
+/// as measured by pinboard_bench. The N * r * p model alone gives 128 for
+/// the recommended parameters, cache misses make it closer to 150.
+template<pow_type PT, uint32_t COST, size_t SIZE, size_t N, size_t P, size_t R>
 class pow_scrypt
 {
 public:
-    static pow_type type()
+    static constexpr pow_type type()
     {
         return PT;
     }
 
-    static size_t digest_size()
+    static constexpr size_t digest_size()
     {
         return SIZE;
     }
@@ -58,18 +95,84 @@ public:
         return scrypt<SIZE>(data, data, N, P, R);
     }
 
-    static uint32_t pow_mul()
+    static constexpr uint32_t cost()
+    {
+        return COST;
+    }
+
+    static constexpr pow_algorithm::calculator calculator()
     {
-        return MUL;
+        return &pow_scrypt::calculate;
     }
 };
 
-typedef pow_scrypt<pow_type::scrypt_14_1_8, 30, 32, 16384, 1, 8> pow_scrypt_14_1_8;
-typedef pow_scrypt<pow_type::scrypt_10_1_1, 10, 32, 1024, 1, 1> pow_scrypt_10_1_1;
+typedef pow_scrypt<pow_type::scrypt_14_1_8, 150, 32, 16384, 1, 8> pow_scrypt_14_1_8;
+typedef pow_scrypt<pow_type::scrypt_10_1_1, 1, 32, 1024, 1, 1> pow_scrypt_10_1_1;
 
 //typedef pow_scrypt_10_1_1 default_pow;
 typedef pow_scrypt_14_1_8 default_pow;
 
+inline uint256_t pow_algorithm::equivalent_target(const uint256_t& target) const
+{
+    // Work is inverse to the target, a cheaper hash needs proportionally more.
+    return target / default_pow::cost() * cost;
+}
+
+template <size_t Index, class... Algorithms>
+struct pow_dispatch_order
+{
+    static constexpr bool value = true;
+};
+
+template <size_t Index, class First, class... Rest>
+struct pow_dispatch_order<Index, First, Rest...>
+{
+    static constexpr bool value = (size_t(First::type()) == Index)
+        && pow_dispatch_order<Index + 1, Rest...>::value;
+};
+
+/**
+ * Table from pow_type to algorithm, generated at compile time from the list
+ * of algorithms. Algorithms must be listed in pow_type order, so the lookup
+ * is a bounds check and an array read.
+ */
+template <class... Algorithms>
+class pow_dispatch
+{
+public:
+    static_assert(pow_dispatch_order<0, Algorithms...>::value,
+                  "pow_dispatch algorithms must be listed in pow_type order");
+
+    static constexpr size_t size()
+    {
+        return sizeof...(Algorithms);
+    }
+
+    /// Returns nullptr for unknown types and types without PoW.
+    static const pow_algorithm* find(pow_type type)
+    {
+        const auto index = static_cast<size_t>(type);
+        if (index >= size() || table_[index].calculate == nullptr)
+            return nullptr;
+
+        return &table_[index];
+    }
+
+private:
+    static const pow_algorithm table_[sizeof...(Algorithms)];
+};
+
+template <class... Algorithms>
+const pow_algorithm pow_dispatch<Algorithms...>::table_[sizeof...(Algorithms)] =
+{
+    { Algorithms::type(), Algorithms::cost(), Algorithms::calculator() }...
+};
+
+typedef pow_dispatch<pow_plain, pow_scrypt_14_1_8, pow_scrypt_10_1_1> pow_algorithms;
+
+static_assert(pow_algorithms::size() == size_t(pow_type::max_pow_type),
+              "every pow_type must have an entry in pow_algorithms");
+
 enum chain_tag : uint32_t {
     unknown         = 0,
     bitcoin_main    = 1,
@@ -146,6 +249,12 @@ public:
         return type_;
     }
 
+    /// Algorithm for the certificate's pow_type, nullptr if unsupported.
+    inline const pow_algorithm* get_pow_algorithm() const
+    {
+        return pow_algorithms::find(type_);
+    }
+
     std::string to_string() const;
 
 private:
@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "prepared_message.hpp"
+
+namespace libbitcoin {
+namespace message {
+
+template <>
+data_chunk serialize<prepared<object>>(uint32_t version,
+    const prepared<object>& packet, uint32_t magic)
+{
+    return packet.wire(version, magic);
+}
+
+template <>
+data_chunk serialize<prepared<object_inventory>>(uint32_t version,
+    const prepared<object_inventory>& packet, uint32_t magic)
+{
+    return packet.wire(version, magic);
+}
+
+template <>
+data_chunk serialize<prepared<inventory>>(uint32_t version,
+    const prepared<inventory>& packet, uint32_t magic)
+{
+    return packet.wire(version, magic);
+}
+
+} // namespace message
+} // namespace libbitcoin
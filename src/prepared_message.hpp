@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_MESSAGE_PREPARED_MESSAGE_HPP
+#define LIBBITCOIN_MESSAGE_PREPARED_MESSAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <bitcoin/bitcoin/message/heading.hpp>
+#include <bitcoin/bitcoin/message/messages.hpp>
+#include <bitcoin/bitcoin/utility/assert.hpp>
+#include <bitcoin/bitcoin/utility/data.hpp>
+
+#include "object.hpp"
+#include "object_inventory.hpp"
+
+namespace libbitcoin {
+namespace message {
+
+/**
+ * A message serialized once, heading and checksum included, for one
+ * protocol version. Broadcasts send the same prepared message to every
+ * channel which negotiated that version.
+ *
+ * The serialize() specializations below hand the wire bytes to the channel
+ * as they are. For other message types the payload is copied and the
+ * heading is rebuilt, which is still correct but not faster.
+ */
+template <class Message>
+class prepared
+{
+public:
+    prepared(const Message& message, uint32_t version, uint32_t magic)
+      : version_(version), magic_(magic),
+        wire_(std::make_shared<const data_chunk>(serialize(version, message, magic)))
+    {
+    }
+
+    uint32_t version() const
+    {
+        return version_;
+    }
+
+    /// Heading and payload.
+    data_chunk wire(uint32_t version, uint32_t magic) const
+    {
+        BITCOIN_ASSERT(version == version_ && magic == magic_);
+        return *wire_;
+    }
+
+    data_chunk to_data(uint32_t version) const
+    {
+        BITCOIN_ASSERT(version == version_);
+        return data_chunk(wire_->begin() + heading::satoshi_fixed_size(), wire_->end());
+    }
+
+    size_t serialized_size(uint32_t version) const
+    {
+        return wire_->size() - heading::satoshi_fixed_size();
+    }
+
+    // A reference, Message::command may not be constructed yet when this
+    // is initialized. Binding to it is constant initialization.
+    static const std::string& command;
+    static const uint32_t version_minimum;
+    static const uint32_t version_maximum;
+
+private:
+    const uint32_t version_;
+    const uint32_t magic_;
+    const std::shared_ptr<const data_chunk> wire_;
+};
+
+template <class Message>
+const std::string& prepared<Message>::command = Message::command;
+
+template <class Message>
+const uint32_t prepared<Message>::version_minimum = Message::version_minimum;
+
+template <class Message>
+const uint32_t prepared<Message>::version_maximum = Message::version_maximum;
+
+// Messages broadcast to pinboard peers.
+template <>
+data_chunk serialize<prepared<object>>(uint32_t version,
+    const prepared<object>& packet, uint32_t magic);
+
+template <>
+data_chunk serialize<prepared<object_inventory>>(uint32_t version,
+    const prepared<object_inventory>& packet, uint32_t magic);
+
+template <>
+data_chunk serialize<prepared<inventory>>(uint32_t version,
+    const prepared<inventory>& packet, uint32_t magic);
+
+} // namespace message
+} // namespace libbitcoin
+
+#endif
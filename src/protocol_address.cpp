@@ -17,6 +17,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <ctime>
 #include <functional>
 #include <bitcoin/bitcoin.hpp>
@@ -41,6 +42,9 @@ using namespace std::placeholders;
 
 static const asio::seconds expiry_interval(60);
 
+// A peer gets at most one get_address answer per this many seconds.
+static const uint32_t get_address_interval = 300;
+
 static message::address configured_self(const network::settings& settings)
 {
     if (settings.self.port() == 0)
@@ -59,7 +63,8 @@ static message::address configured_self(const network::settings& settings)
 protocol_address::protocol_address(lite_node& network, typename channel<message_subscriber_ex>::ptr channel)
   : protocol_timer<message_subscriber_ex>(network, channel, true, NAME),
     CONSTRUCT_TRACK(protocol_address),
-    network_(network), self_(configured_self(network_.network_settings()))
+    network_(network), outbound_(network.outbound(channel)),
+    self_(configured_self(network_.network_settings())), next_answer_(0)
 {
 }
 
@@ -75,7 +80,7 @@ void protocol_address::start()
 
     if (!self_.addresses().empty())
     {
-        SEND2(self_, handle_send, _1, self_.command);
+        outbound_->send(send_queue::priority::control, self_, BIND2(handle_send, _1, self_.command));
     }
 
     // If we can't store addresses we don't ask for or handle them.
@@ -86,7 +91,7 @@ void protocol_address::start()
 
     SUBSCRIBE2(address, handle_receive_address, _1, _2);
     SUBSCRIBE2(get_address, handle_receive_get_address, _1, _2);
-    SEND2(get_address{}, handle_send, _1, get_address::command);
+    outbound_->send(send_queue::priority::control, get_address{}, BIND2(handle_send, _1, get_address::command));
 }
 
 // Protocol.
@@ -113,31 +118,47 @@ bool protocol_address::handle_receive_get_address(const code& ec, get_address_co
     if (this->stopped(ec))
         return false;
 
-    // TODO: allowing repeated queries can allow a channel to map our history.
-    // TODO: pull active hosts from host cache (currently just resending self).
     // TODO: need to distort for privacy, don't send currently-connected peers.
-    // TODO: response size limit is max_address (1000).
 
-    network_address::list l;
-    network_.fetch_addresses(l, 1u << PINBOARD_SERVICE_BIT);
+    // Repeated queries get nothing new, and would let a peer map our history.
+    const auto now = static_cast<uint32_t>(time(nullptr));
+    auto next = next_answer_.load();
+    if (now < next || !next_answer_.compare_exchange_strong(next, now + get_address_interval))
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Ignoring repeated get_address from [" << this->authority() << "]";
+        return true;
+    }
 
-    for (const auto &addr : self_.addresses())
+    // A random sample of at most max_address - 1, shared with other peers.
+    auto sample = network_.sample_pinboard_addresses();
+
+    if (!self_.addresses().empty())
     {
-        network_address netaddr = addr;
-        netaddr.set_timestamp(static_cast<uint32_t>(time(nullptr)));
+        network_address::list l;
+        l.reserve(max_address);
+        for (const auto &addr : self_.addresses())
+        {
+            network_address netaddr = addr;
+            netaddr.set_timestamp(now);
+
+            l.push_back(netaddr);
+        }
 
-        l.push_back(netaddr);
+        const auto& sampled = sample->addresses();
+        const auto room = max_address - std::min(l.size(), max_address);
+        l.insert(l.end(), sampled.begin(), sampled.begin() + std::min(sampled.size(), room));
+        sample = std::make_shared<const message::address>(std::move(l));
     }
 
-    if (l.empty())
+    if (sample->addresses().empty())
         return true; // Nothing to send. Let's try again later.
 
     LOG_DEBUG(LOG_NETWORK)
         << "Sending addresses to [" << this->authority() << "] ("
-        << l.size() << ")";
+        << sample->addresses().size() << ")";
 
-    message::address addr(l);
-    SEND2(addr, handle_send, _1, addr.command);
+    outbound_->send(send_queue::priority::control, sample, BIND2(handle_send, _1, message::address::command));
 
 
     // RESUBSCRIBE
@@ -198,7 +219,7 @@ void protocol_address::handle_event(const code& ec)
         LOG_INFO(LOG_NETWORK)
             << "Not enougth pinboard addresses known. Requesting more from [" << authority() << "]";
 
-        SEND2(get_address{}, handle_send, _1, get_address::command);
+        outbound_->send(send_queue::priority::control, get_address{}, BIND2(handle_send, _1, get_address::command));
     }
 }
 
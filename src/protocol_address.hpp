@@ -19,12 +19,16 @@
 #ifndef LIBBITCOIN_NETWORK_PROTOCOL_ADDRESS_HPP
 #define LIBBITCOIN_NETWORK_PROTOCOL_ADDRESS_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <altcoin/network/channel.hpp>
 #include <altcoin/network/define.hpp>
 #include <altcoin/network/protocols/protocol_timer.hpp>
 
+#include "send_queue.hpp"
+
 namespace libbitcoin {
 
 namespace network { class message_subscriber_ex; }
@@ -69,7 +73,9 @@ protected:
     void handle_event(const code& ec);
 
     lite_node& network_;
+    send_queue::ptr outbound_;
     const message::address self_;
+    std::atomic<uint32_t> next_answer_;
 };
 
 } // namespace network
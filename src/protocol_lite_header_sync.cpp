@@ -16,9 +16,9 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <functional>
-#include <list>
 #include <altcoin/network.hpp>
 
 #include "lite_node.hpp"
@@ -35,7 +35,8 @@ using namespace bc::message;
 using namespace bc::network;
 using namespace std::placeholders;
 
-static const asio::seconds expiry_interval(60);
+// Also the period of taking over requests stalled at other peers.
+static const asio::seconds expiry_interval(10);
 
 // This class requires protocol version 31800.
 protocol_lite_header_sync::protocol_lite_header_sync(lite_node& network,
@@ -43,7 +44,10 @@ protocol_lite_header_sync::protocol_lite_header_sync(lite_node& network,
     chain_sync_state::ptr chain_state)
   : protocol_timer<message_subscriber_ex>(network, channel, true, NAME),
     CONSTRUCT_TRACK(protocol_lite_header_sync),
-    chain_state_(chain_state)
+    node_(network),
+    outbound_(network.outbound(channel)),
+    chain_state_(chain_state),
+    request_sent_(0)
 {
 }
 
@@ -93,33 +97,62 @@ bool protocol_lite_header_sync::handle_receive_inventory(const code& ec,
 
 bool protocol_lite_header_sync::request_missing_headers(const bc::hash_digest &last)
 {
-    const std::set<bc::hash_digest> known_headers = chain_state_->get_last_known_block_hash();
-    LOG_INFO(LOG_PROTO_HEADER_SYNC) << "Found known headers: " << known_headers.size() << " pieces";
+    const hash_list locator = chain_state_->get_block_locator();
+    const hash_digest &tip = locator.front();
 
-    for (const auto &first : known_headers)
-    {
-        if (first != last)
-        {
-            const get_headers request
-                    {
-                            {first},
-                            last
-                    };
-
-            SEND2(request, handle_send, _1, request.command);
-        } else
-            return false;
-    }
+    if (tip == last)
+        return false;
+
+    // Another channel is already downloading from this tip.
+    if (!node_.header_scheduler().acquire(tip, authority()))
+        return true;
+
+    LOG_INFO(LOG_PROTO_HEADER_SYNC) << "Requesting headers after " << bc::encode_base16(tip)
+                                    << " with " << locator.size() << " locator hashes";
 
+    send_request({ locator, last });
     return true;
 }
 
+void protocol_lite_header_sync::request_stalled_headers()
+{
+    const hash_list locator = chain_state_->get_block_locator();
+    const hash_digest &tip = locator.front();
+
+    if (!node_.header_scheduler().take_over(tip, authority()))
+        return;
+
+    LOG_INFO(LOG_PROTO_HEADER_SYNC) << "Taking over stalled header request from "
+                                    << bc::encode_base16(tip);
+
+    send_request({ locator, bc::null_hash });
+}
+
+// The answer time is the round trip the peer is scored by.
+void protocol_lite_header_sync::send_request(const get_headers& request)
+{
+    const auto now = std::chrono::steady_clock::now();
+    request_sent_.store(now.time_since_epoch().count());
+    outbound_->send(send_queue::priority::control, request, BIND2(handle_send, _1, request.command));
+}
+
 bool protocol_lite_header_sync::handle_receive_headers(const code& ec,
     headers_const_ptr message, event_handler complete)
 {
     if (stopped(ec))
         return false;
 
+    // Answered, let the next request go to any peer.
+    node_.header_scheduler().release(authority());
+
+    const auto sent = request_sent_.exchange(0);
+    if (sent != 0)
+    {
+        typedef std::chrono::steady_clock clock;
+        const auto round_trip = clock::now() - clock::time_point(clock::duration(sent));
+        node_.scores().round_trip(authority(), round_trip);
+    }
+
     code merge_error = chain_state_->merge(message);
     if (merge_error != error::success)
     {
@@ -143,106 +176,18 @@ bool protocol_lite_header_sync::handle_receive_get_headers(const code& ec, get_h
     if (stopped(ec))
         return false;
 
-    const hash_list& start_list = message->start_hashes();
-    hash_digest stop = message->stop_hash();
-    bc::chain::lite_header lh;
-
-    if (!chain_state_->get_header_by_id(stop, lh))
+    // Our main chain after the fork point, up to the stop hash.
+    const auto response = std::make_shared<serialized_headers>();
+    if (!chain_state_->get_headers(message->start_hashes(), message->stop_hash(), max_get_headers, *response))
     {
-        LOG_INFO(LOG_NETWORK) << "Can't find stop header by id " << bc::encode_base16(stop);
-        LOG_INFO(LOG_NETWORK) << "Assuming current chain top.";
-        const std::set<hash_digest> top = chain_state_->get_last_known_block_hash();
-        if (top.empty())
-        {
-            LOG_WARNING(LOG_NETWORK) << "Our chain top is empty. Strange :/";
-        }
-
-        for (const auto &h : top)
-        {
-            if (h != null_hash)
-            {
-                stop = h;
-                break;
-                // Warning: this is possibly wrong assumption.
-            }
-        }
-
-        if (stop == null_hash)
-        {
-            LOG_WARNING(LOG_NETWORK) << "Still can't find not null chain top. Very strange :/";
-            return true;
-        }
-    }
-
-    std::list<hash_digest> missing_headers;
-    missing_headers.push_front(stop);
-
-    hash_digest known_start = null_hash;
-    hash_list::const_iterator iter = start_list.begin();
-    size_t max_height = 0;
-    while (iter != start_list.end())
-    {
-        if (!chain_state_->get_header_by_id(*iter, lh))
-        {
-            LOG_INFO(LOG_NETWORK) << "Can't find start header by id " << bc::encode_base16(*iter);
-            iter++;
-
-            continue;
-        }
-
-        if (lh.validation.height > max_height)
-        {
-            max_height = lh.validation.height;
-            known_start = lh.hash();
-        }
-
-        iter++;
-    }
-
-    if (known_start == null_hash)
-    {
-        LOG_WARNING(LOG_NETWORK) << "Don't know all of requested start headers.";
+        LOG_WARNING(LOG_NETWORK) << "Don't know any of requested start headers.";
         return true;
     }
 
-    while (missing_headers.front() != known_start)
-    {
-        hash_digest prev = null_hash;
-
-        if (!chain_state_->get_prev_hash_by_id(missing_headers.front(), prev))
-        {
-            LOG_ERROR(LOG_NETWORK) << "Can't find prev hash for known header "
-                                   << bc::encode_base16(missing_headers.front());
-            return true;
-        }
-
-        if (prev == known_start)
-            break;
-
-        missing_headers.push_front(prev);
-    }
-
-    headers new_msg;
-
-    while (!missing_headers.empty())
-    {
-        const auto id = missing_headers.front();
-        missing_headers.pop_front();
-        bc::chain::lite_header lh;
-        if (!chain_state_->get_header_by_id(id, lh))
-        {
-            LOG_ERROR(LOG_NETWORK) << "Can't find header by id " << bc::encode_base16(id);
-            return true;
-        }
-
-        data_chunk d = lh.to_data();
-        new_msg.elements().emplace_back(std::move(chain::header::factory_from_data(d)));
-        if (new_msg.elements().size() == max_get_headers)
-            break;
-    }
-
-    if (!new_msg.elements().empty())
-        SEND2(new_msg, handle_send, _1, new_msg.command);
+    if (!response->empty() &&
+        !outbound_->send<serialized_headers>(send_queue::priority::headers, response,
+                                             BIND2(handle_send, _1, serialized_headers::command)))
+        LOG_WARNING(LOG_NETWORK) << "Send queue of [" << authority() << "] is full, dropping headers.";
 
     return true;
 }
@@ -251,7 +196,10 @@ bool protocol_lite_header_sync::handle_receive_get_headers(const code& ec, get_h
 void protocol_lite_header_sync::handle_event(const code& ec, event_handler complete)
 {
     if (stopped(ec))
+    {
+        node_.header_scheduler().release(authority());
         return;
+    }
 
     if (ec && ec != error::channel_timeout)
     {
@@ -261,6 +209,8 @@ void protocol_lite_header_sync::handle_event(const code& ec, event_handler compl
         complete(ec);
         return;
     }
+
+    request_stalled_headers();
 }
 
 void protocol_lite_header_sync::headers_complete(const code& ec,
@@ -17,6 +17,7 @@
 #ifndef LIBBITCOIN_NODE_PROTOCOL_LITE_HEADER_SYNC_HPP
 #define LIBBITCOIN_NODE_PROTOCOL_LITE_HEADER_SYNC_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -24,6 +25,7 @@
 #include <altcoin/network.hpp>
 
 #include "chain_listener.hpp"
+#include "send_queue.hpp"
 
 #define LOG_PROTO_HEADER_SYNC "proto_header_sync"
 
@@ -59,8 +61,15 @@ private:
     bool handle_receive_inventory(const code& ec, inventory_const_ptr message, event_handler complete);
 
     bool request_missing_headers(const hash_digest &last);
+    void request_stalled_headers();
+    void send_request(const message::get_headers& request);
 
+    lite_node& node_;
+    send_queue::ptr outbound_;
     chain_sync_state::ptr chain_state_;
+
+    // Steady clock ticks of the get_headers in flight, zero if none.
+    std::atomic<int64_t> request_sent_;
 };
 
 } // namespace node
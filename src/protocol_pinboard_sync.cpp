@@ -36,7 +36,14 @@ using namespace bc::message;
 using namespace bc::network;
 using namespace std::placeholders;
 
-static const asio::seconds expiry_interval(600);
+// Stalled object requests are taken over on this tick.
+static const asio::seconds expiry_interval(10);
+
+// Enough to decode about 60 missing objects in one round trip.
+static const size_t initial_sketch_cells = 96;
+
+// Larger get_objects requests are served as backfill.
+static const size_t max_fresh_request = 8;
 
 // This class requires protocol version 31800.
 protocol_pinboard_sync::protocol_pinboard_sync(lite_node& network,
@@ -45,8 +52,13 @@ protocol_pinboard_sync::protocol_pinboard_sync(lite_node& network,
     pinboard::ptr pinboard)
   : protocol_timer<message_subscriber_ex>(network, channel, true, NAME),
     CONSTRUCT_TRACK(protocol_pinboard_sync),
+    node_(network),
+    outbound_(network.outbound(channel)),
     chain_state_(chain_state),
-    pinboard_(pinboard)
+    pinboard_(pinboard),
+    served_cells_(initial_sketch_cells),
+    expected_cells_(initial_sketch_cells),
+    announced_all_(false)
 {
 }
 
@@ -68,6 +80,12 @@ void protocol_pinboard_sync::start(event_handler handler)
         protocol_timer::start(expiry_interval, BIND2(handle_event, _1, complete));
         SUBSCRIBE3(object, handle_receive_object, _1, _2, complete);
         SUBSCRIBE2(inventory, handle_receive_inventory, _1, _2);
+        SUBSCRIBE2(object_inventory, handle_receive_object_inventory, _1, _2);
+        SUBSCRIBE2(get_objects, handle_receive_get_objects, _1, _2);
+        SUBSCRIBE2(board_sketch, handle_receive_board_sketch, _1, _2);
+
+        // Reconcile the boards, each side announces what the other lacks.
+        send_sketch(initial_sketch_cells);
 
         auto peer_start_height = peer_version()->start_height();
         const std::set<bc::hash_digest> hashes = chain_state_->get_known_block_hashes(peer_start_height);
@@ -141,19 +159,22 @@ bool protocol_pinboard_sync::handle_receive_inventory(const code& ec, inventory_
                     LOG_INFO(LOG_NETWORK) << "PINBOARD: updated [" << authority()
                                           << "] sync state to height " << new_height;
 
-                    pinboard_->for_each([this, max_old_height, new_height](const object_payload& op)
+                    // Announce the objects anchored in the new range, the
+                    // peer asks for those it lacks.
+                    object_inventory announcement;
+                    pinboard_->for_each([this, max_old_height, new_height, &announcement](const object_payload& op)
                     {
                         const auto& anchor = op.get_anchor();
                         size_t anchor_height = 0;
                         if (chain_state_->get_height_by_id(anchor, anchor_height))
                         {
                             if (anchor_height > max_old_height && anchor_height <= new_height)
-                            {
-                                const object obj(op);
-                                SEND2(obj, handle_send, _1, obj.command);
-                            }
+                                announcement.ids().push_back(op.get_id());
                         }
                     });
+
+                    if (!announcement.ids().empty())
+                        outbound_->send(send_queue::priority::backfill, announcement, BIND2(handle_send, _1, announcement.command));
                 }
             }
             else
@@ -180,7 +201,16 @@ bool protocol_pinboard_sync::handle_receive_object(const code& ec,
 
     LOG_INFO(LOG_NETWORK) << "PINBOARD: handle_receive_object from [" << authority() << "]";
 
+    const auto valid = message->payload().is_valid();
+    const auto id = valid ? message->payload().get_id() : null_hash;
+    const auto known = valid && pinboard_->contains(id);
+
+    object_request_tracker::clock::duration latency;
+    if (valid && node_.object_tracker().received(id, authority(), latency))
+        node_.scores().delivered(authority(), latency);
+
     code error = pinboard_->process(message, [](const code& wb_ec, object_const_ptr message){});
+    node_.scores().received(authority(), valid && !known && !error);
 
     if (error == error::invalid_proof_of_work || error == error::bad_stream)
     {
@@ -193,6 +223,177 @@ bool protocol_pinboard_sync::handle_receive_object(const code& ec,
     return true;
 }
 
+bool protocol_pinboard_sync::handle_receive_object_inventory(const code& ec,
+                                                               object_inventory_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    LOG_INFO(LOG_NETWORK) << "PINBOARD: " << message->ids().size()
+                          << " objects announced by [" << authority() << "]";
+
+    hash_list missing;
+    for (const auto& id : message->ids())
+        if (!pinboard_->contains(id) && node_.object_tracker().announce(id, authority()))
+            missing.push_back(id);
+
+    request_objects(std::move(missing));
+    return true;
+}
+
+bool protocol_pinboard_sync::handle_receive_get_objects(const code& ec, get_objects_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    LOG_INFO(LOG_NETWORK) << "PINBOARD: " << message->ids().size()
+                          << " objects requested by [" << authority() << "]";
+
+    // Single objects answer live announcements, batches are board sync.
+    const auto level = message->ids().size() <= max_fresh_request ?
+        send_queue::priority::fresh : send_queue::priority::backfill;
+
+    // Bodies go as they are stored to peers which can inflate them.
+    const auto compact = (peer_version()->services() & (1u << PINBOARD_COMPRESSION_BIT)) != 0;
+
+    // Objects evicted since they were announced are skipped. When the queue
+    // is full the peer requests the rest again after a timeout.
+    for (const auto& id : message->ids())
+    {
+        const auto obj = pinboard_->get_object(id);
+        if (!obj)
+            continue;
+
+        const auto queued = compact ?
+            outbound_->send(level, std::make_shared<const compressed_object>(obj->payload()),
+                            BIND2(handle_send, _1, compressed_object::command)) :
+            outbound_->send(level, obj, BIND2(handle_send, _1, object::command));
+
+        if (!queued)
+        {
+            LOG_INFO(LOG_NETWORK) << "PINBOARD: send queue of [" << authority() << "] is full";
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool protocol_pinboard_sync::handle_receive_board_sketch(const code& ec, board_sketch_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    // Only the next round is served, a sketch costs a scan of the board.
+    const size_t requested = message->requested_cells();
+    auto served = requested / 2;
+    if (requested > 0)
+    {
+        if (requested <= id_sketch::max_cells && requested % 2 == 0 &&
+            served_cells_.compare_exchange_strong(served, requested))
+            send_sketch(requested);
+        else
+            LOG_INFO(LOG_NETWORK) << "PINBOARD: ignoring request of a sketch of "
+                                  << requested << " cells from [" << authority() << "]";
+    }
+
+    const auto cells = message->sketch().cells();
+    if (cells == 0)
+        return true;
+
+    // Sketches not asked for are ignored likewise.
+    auto expected = cells;
+    if (!expected_cells_.compare_exchange_strong(expected, 0))
+    {
+        LOG_INFO(LOG_NETWORK) << "PINBOARD: ignoring unexpected sketch of "
+                              << cells << " cells from [" << authority() << "]";
+        return true;
+    }
+
+    auto difference = pinboard_->get_sketch(cells);
+    difference.subtract(message->sketch());
+
+    hash_list ours;
+    hash_list theirs;
+    if (difference.decode(ours, theirs))
+    {
+        LOG_INFO(LOG_NETWORK) << "PINBOARD: boards of [" << authority() << "] differ by "
+                              << ours.size() << " local and " << theirs.size() << " remote objects";
+
+        announce_objects(ours);
+
+        // Ask for the peer's objects now, its announcement is then ignored.
+        hash_list missing;
+        for (const auto& id : theirs)
+            if (!pinboard_->contains(id) && node_.object_tracker().announce(id, authority()))
+                missing.push_back(id);
+
+        request_objects(std::move(missing));
+        return true;
+    }
+
+    // Both sides fail alike and ask each other for a larger sketch.
+    if (cells * 2 <= id_sketch::max_cells)
+    {
+        expected_cells_.store(cells * 2);
+        const board_sketch request(static_cast<uint32_t>(cells * 2), id_sketch());
+        outbound_->send(send_queue::priority::control, request, BIND2(handle_send, _1, request.command));
+        return true;
+    }
+
+    if (announced_all_.exchange(true))
+        return true;
+
+    LOG_INFO(LOG_NETWORK) << "PINBOARD: board of [" << authority() << "] differs too much, announcing all objects";
+    announce_objects(pinboard_->get_ids());
+    return true;
+}
+
+void protocol_pinboard_sync::send_sketch(size_t cells)
+{
+    const board_sketch sketch(0, pinboard_->get_sketch(cells));
+    outbound_->send(send_queue::priority::control, sketch, BIND2(handle_send, _1, sketch.command));
+}
+
+void protocol_pinboard_sync::announce_objects(const hash_list& ids)
+{
+    for (auto first = ids.begin(); first != ids.end();)
+    {
+        const auto last = first + std::min<size_t>(ids.end() - first, max_inventory);
+        const object_inventory announcement(hash_list(first, last));
+        if (!outbound_->send(send_queue::priority::backfill, announcement,
+                             BIND2(handle_send, _1, announcement.command)))
+        {
+            LOG_INFO(LOG_NETWORK) << "PINBOARD: send queue of [" << authority() << "] is full";
+            break;
+        }
+
+        first = last;
+    }
+}
+
+void protocol_pinboard_sync::request_objects(hash_list&& ids)
+{
+    if (ids.empty())
+        return;
+
+    const get_objects request(std::move(ids));
+    outbound_->send(send_queue::priority::control, request, BIND2(handle_send, _1, request.command));
+}
+
+// Take over requests of this peer's announcements which another peer
+// failed to deliver.
+void protocol_pinboard_sync::request_stalled_objects()
+{
+    auto ids = node_.object_tracker().take_over(authority());
+
+    if (!ids.empty())
+        LOG_INFO(LOG_NETWORK) << "PINBOARD: re-requesting " << ids.size()
+                              << " objects from [" << authority() << "]";
+
+    request_objects(std::move(ids));
+}
+
 bool protocol_pinboard_sync::send_object(const object_payload& op)
 {
     LOG_INFO(LOG_NETWORK) << "PINBOARD: send_object to [" << authority() << "]";
@@ -227,17 +428,16 @@ bool protocol_pinboard_sync::send_object(const object_payload& op)
             {
                 const auto id = missing_headers.back();
                 missing_headers.pop_back();
-                bc::chain::lite_header lh;
+                bc::chain::header_record lh;
                 if (!chain_state_->get_header_by_id(id, lh))
                 {
                     LOG_ERROR(LOG_NETWORK) << "PINBOARD: can't find header by id " << bc::encode_base16(id);
                     return false;
                 }
-                data_chunk d = lh.to_data();
-                new_msg.elements().emplace_back(std::move(chain::header::factory_from_data(d)));
+                new_msg.elements().emplace_back(lh.to_header());
                 if (new_msg.elements().size() == 2000)
                 {
-                    SEND2(new_msg, handle_send, _1, new_msg.command);
+                    outbound_->send(send_queue::priority::headers, new_msg, BIND2(handle_send, _1, new_msg.command));
                     oldest_known_hashes.clear();
                     oldest_known_hashes.insert(id);
                     new_msg.elements().clear();
@@ -247,7 +447,7 @@ bool protocol_pinboard_sync::send_object(const object_payload& op)
 
             if (!new_msg.elements().empty())
             {
-                SEND2(new_msg, handle_send, _1, new_msg.command);
+                outbound_->send(send_queue::priority::headers, new_msg, BIND2(handle_send, _1, new_msg.command));
                 oldest_known_hashes.clear();
                 oldest_known_hashes.insert(new_msg.elements()[new_msg.elements().size() - 1].hash());
             }
@@ -255,7 +455,7 @@ bool protocol_pinboard_sync::send_object(const object_payload& op)
     }
 
     const object obj(op);
-    SEND2(obj, handle_send, _1, obj.command);
+    outbound_->send(send_queue::priority::backfill, obj, BIND2(handle_send, _1, obj.command));
 
     return true;
 }
@@ -264,7 +464,10 @@ bool protocol_pinboard_sync::send_object(const object_payload& op)
 void protocol_pinboard_sync::handle_event(const code& ec, event_handler complete)
 {
     if (stopped(ec))
+    {
+        node_.object_tracker().release(authority());
         return;
+    }
 
     if (ec && ec != error::channel_timeout)
     {
@@ -274,6 +477,8 @@ void protocol_pinboard_sync::handle_event(const code& ec, event_handler complete
         complete(ec);
         return;
     }
+
+    request_stalled_objects();
 }
 
 } // namespace node
@@ -17,6 +17,7 @@
 #ifndef LIBBITCOIN_NODE_PROTOCOL_PINBOARD_SYNC_HPP
 #define LIBBITCOIN_NODE_PROTOCOL_PINBOARD_SYNC_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -25,7 +26,10 @@
 
 #include "chain_listener.hpp"
 #include "pinboard.hpp"
+#include "send_queue.hpp"
+#include "board_sketch.hpp"
 #include "object.hpp"
+#include "object_inventory.hpp"
 
 namespace libbitcoin {
 
@@ -55,13 +59,27 @@ public:
 private:
     bool handle_receive_object(const code& ec, object_const_ptr message, event_handler complete);
     bool handle_receive_inventory(const code& ec, inventory_const_ptr message);
+    bool handle_receive_object_inventory(const code& ec, object_inventory_const_ptr message);
+    bool handle_receive_get_objects(const code& ec, get_objects_const_ptr message);
+    bool handle_receive_board_sketch(const code& ec, board_sketch_const_ptr message);
     void handle_event(const code& ec, event_handler complete);
 
     void pinboard_complete(const code& ec, event_handler handler);
+    void send_sketch(size_t cells);
+    void announce_objects(const hash_list& ids);
+    void request_objects(hash_list&& ids);
+    void request_stalled_objects();
 
+    lite_node& node_;
+    send_queue::ptr outbound_;
     chain_sync_state::ptr chain_state_;
     pinboard::ptr pinboard_;
 
+    // Reconciliation runs once per channel, each round doubling the sketch.
+    std::atomic<size_t> served_cells_;      // of the last sketch sent
+    std::atomic<size_t> expected_cells_;    // of the sketch awaited, zero if none
+    std::atomic<bool> announced_all_;
+
     // -------------------------------------------------------------------------
     mutable bc::upgrade_mutex mutex_;
     std::set<hash_digest> oldest_known_hashes;
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "send_queue.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace libbitcoin {
+namespace node {
+
+// Bytes handed to the channel and not sent yet.
+static const size_t send_window = 256 * 1024;
+
+// Bounds of the queued bytes by priority class.
+static const std::array<size_t, 4> queue_limits
+{
+    {
+        64 * 1024,          // control
+        1024 * 1024,        // headers
+        2 * 1024 * 1024,    // fresh
+        4 * 1024 * 1024     // backfill
+    }
+};
+
+send_queue::send_queue(channel_ptr channel)
+  : channel_(channel), in_flight_(0), sending_(false), stopped_(false)
+{
+    queued_.fill(0);
+}
+
+size_t send_queue::queued_bytes() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    shared_lock lock(mutex_);
+
+    size_t total = 0;
+    for (const auto bytes : queued_)
+        total += bytes;
+
+    return total;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void send_queue::stop()
+{
+    std::vector<entry> dropped;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    mutex_.lock();
+
+    stopped_ = true;
+
+    for (auto& queue : queues_)
+    {
+        for (auto& value : queue)
+            dropped.push_back(std::move(value));
+
+        queue.clear();
+    }
+
+    queued_.fill(0);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto& value : dropped)
+        if (value.handler)
+            value.handler(error::channel_stopped);
+}
+
+// private
+bool send_queue::push(priority level, size_t bytes, job&& send, result_handler&& handler)
+{
+    const auto index = static_cast<size_t>(level);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    mutex_.lock();
+
+    // An empty queue takes any message, so a large one is not refused
+    // forever.
+    if (stopped_ || (queued_[index] > 0 && queued_[index] + bytes > queue_limits[index]))
+    {
+        mutex_.unlock();
+        return false;
+    }
+
+    queued_[index] += bytes;
+    queues_[index].push_back(entry{ bytes, std::move(send), std::move(handler) });
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    pump();
+    return true;
+}
+
+// private
+// One thread at a time hands messages to the channel, so they reach it in
+// queue order. Others only queue, the sending thread picks their messages
+// up before it stops.
+void send_queue::pump()
+{
+    const auto self = shared_from_this();
+    std::vector<entry> ready;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    mutex_.lock();
+
+    if (sending_)
+    {
+        mutex_.unlock();
+        return;
+    }
+
+    sending_ = true;
+
+    while (true)
+    {
+        while (!stopped_ && in_flight_ < send_window)
+        {
+            size_t index = 0;
+            while (index < classes && queues_[index].empty())
+                index++;
+
+            if (index == classes)
+                break;
+
+            auto& queue = queues_[index];
+            queued_[index] -= queue.front().bytes;
+            in_flight_ += queue.front().bytes;
+            ready.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+
+        if (ready.empty())
+            break;
+
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+
+        // The channel is called outside of the lock, it may complete at once.
+        for (const auto& value : ready)
+        {
+            const auto bytes = value.bytes;
+            const auto handler = value.handler;
+            value.send([self, bytes, handler](const code& ec)
+            {
+                self->handle_sent(ec, bytes, handler);
+            });
+        }
+
+        ready.clear();
+
+        //---------------------------------------------------------------------
+        mutex_.lock();
+    }
+
+    sending_ = false;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+void send_queue::handle_sent(const code& ec, size_t bytes, result_handler handler)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section.
+    mutex_.lock();
+    in_flight_ -= bytes;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (handler)
+        handler(ec);
+
+    pump();
+}
+
+} // namespace node
+} // namespace libbitcoin
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NODE_SEND_QUEUE_HPP
+#define LIBBITCOIN_NODE_SEND_QUEUE_HPP
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include <altcoin/network.hpp>
+#include <bitcoin/bitcoin/message/heading.hpp>
+
+#include "message_subscriber_ex.hpp"
+
+namespace libbitcoin {
+namespace node {
+
+/**
+ * Outbound scheduler of one channel, thread safe.
+ *
+ * Messages wait in byte bounded queues, one per priority class, and are
+ * handed to the channel, highest class first, while less than a window of
+ * bytes is in flight. Lower classes can't delay pings or header replies
+ * by more than the window, and a peer that reads slowly can't make us
+ * buffer more than the queue bounds: send() refuses the message instead.
+ */
+class send_queue
+  : public std::enable_shared_from_this<send_queue>
+{
+public:
+    typedef std::shared_ptr<send_queue> ptr;
+    typedef network::channel<network::message_subscriber_ex>::ptr channel_ptr;
+    typedef std::function<void(const code&)> result_handler;
+
+    enum class priority
+    {
+        control,        // requests, addresses, sketches
+        headers,        // header replies
+        fresh,          // new objects and their announcements
+        backfill        // board sync
+    };
+
+    explicit send_queue(channel_ptr channel);
+
+    /// Queue message, false if the queue of its class is full. The handler
+    /// is called once the channel sent it, or with channel_stopped.
+    template <class Message>
+    bool send(priority level, std::shared_ptr<const Message> message,
+        result_handler handler)
+    {
+        const auto channel = channel_;
+        const auto bytes = message::heading::satoshi_fixed_size() +
+            message->serialized_size(channel->negotiated_version());
+
+        return push(level, bytes, [channel, message](result_handler sent)
+        {
+            channel->send(*message, sent);
+        }, std::move(handler));
+    }
+
+    template <class Message>
+    bool send(priority level, const Message& message, result_handler handler)
+    {
+        return send(level, std::make_shared<const Message>(message), std::move(handler));
+    }
+
+    /// Drop the queued messages, their handlers get channel_stopped.
+    void stop();
+
+    size_t queued_bytes() const;
+
+private:
+    typedef std::function<void(result_handler)> job;
+
+    struct entry
+    {
+        size_t bytes;
+        job send;
+        result_handler handler;
+    };
+
+    static const size_t classes = 4;
+
+    bool push(priority level, size_t bytes, job&& send, result_handler&& handler);
+    void pump();
+    void handle_sent(const code& ec, size_t bytes, result_handler handler);
+
+    const channel_ptr channel_;
+
+    // -------------------------------------------------------------------------
+    mutable upgrade_mutex mutex_;
+    std::array<std::deque<entry>, classes> queues_;
+    std::array<size_t, classes> queued_;
+    size_t in_flight_;
+    bool sending_;              // a thread is handing messages to the channel
+    bool stopped_;
+    // -------------------------------------------------------------------------
+};
+
+} // namespace node
+} // namespace libbitcoin
+
+#endif
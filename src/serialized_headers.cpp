@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bitcoin/bitcoin/message/messages.hpp>
+#include <bitcoin/bitcoin/utility/assert.hpp>
+#include <bitcoin/bitcoin/utility/container_sink.hpp>
+#include <bitcoin/bitcoin/utility/ostream_writer.hpp>
+
+#include "serialized_headers.hpp"
+
+namespace libbitcoin {
+namespace message {
+
+// Sent as a regular headers message.
+const std::string serialized_headers::command = "headers";
+const uint32_t serialized_headers::version_minimum = version::level::headers;
+const uint32_t serialized_headers::version_maximum = version::level::maximum;
+
+serialized_headers::serialized_headers()
+  : count_(0)
+{
+}
+
+size_t serialized_headers::size() const
+{
+    return count_;
+}
+
+bool serialized_headers::empty() const
+{
+    return count_ == 0;
+}
+
+data_chunk& serialized_headers::data()
+{
+    return data_;
+}
+
+void serialized_headers::set_count(size_t count)
+{
+    count_ = count;
+}
+
+data_chunk serialized_headers::to_data(uint32_t version) const
+{
+    data_chunk data;
+    const auto size = serialized_size(version);
+    data.reserve(size);
+    data_sink ostream(data);
+    to_data(version, ostream);
+    ostream.flush();
+    BITCOIN_ASSERT(data.size() == size);
+    return data;
+}
+
+void serialized_headers::to_data(uint32_t version, std::ostream& stream) const
+{
+    ostream_writer sink(stream);
+    to_data(version, sink);
+}
+
+void serialized_headers::to_data(uint32_t version, writer& sink) const
+{
+    sink.write_variable_little_endian(count_);
+    sink.write_bytes(data_);
+}
+
+size_t serialized_headers::serialized_size(uint32_t version) const
+{
+    return variable_uint_size(count_) + data_.size();
+}
+
+} // namespace message
+} // namespace libbitcoin
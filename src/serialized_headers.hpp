@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_MESSAGE_SERIALIZED_HEADERS_HPP
+#define LIBBITCOIN_MESSAGE_SERIALIZED_HEADERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <bitcoin/bitcoin/define.hpp>
+#include <bitcoin/bitcoin/utility/data.hpp>
+#include <bitcoin/bitcoin/utility/writer.hpp>
+
+namespace libbitcoin {
+namespace message {
+
+/**
+ * Outgoing headers message whose headers are already in wire format
+ * (80 bytes and a zero transaction count each), see header_store.
+ * Sending it copies the bytes instead of serializing header objects.
+ */
+class BC_API serialized_headers
+{
+public:
+    serialized_headers();
+
+    size_t size() const;
+    bool empty() const;
+
+    /// Buffer receiving the serialized headers, count is their number.
+    data_chunk& data();
+    void set_count(size_t count);
+
+    data_chunk to_data(uint32_t version) const;
+    void to_data(uint32_t version, std::ostream& stream) const;
+    void to_data(uint32_t version, writer& sink) const;
+    size_t serialized_size(uint32_t version) const;
+
+    static const std::string command;
+    static const uint32_t version_minimum;
+    static const uint32_t version_maximum;
+
+private:
+    size_t count_;
+    data_chunk data_;
+};
+
+} // namespace message
+} // namespace libbitcoin
+
+#endif
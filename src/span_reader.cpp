@@ -0,0 +1,280 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "span_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <boost/endian/conversion.hpp>
+#include <bitcoin/bitcoin/constants.hpp>
+
+namespace libbitcoin {
+
+span_reader::span_reader(const uint8_t* begin, const uint8_t* end)
+  : position_(begin), end_(end), valid_(true)
+{
+}
+
+span_reader::span_reader(const data_chunk& data)
+  : span_reader(data.data(), data.data() + data.size())
+{
+}
+
+// Context.
+// ----------------------------------------------------------------------------
+
+span_reader::operator bool() const
+{
+    return valid_;
+}
+
+bool span_reader::operator!() const
+{
+    return !valid_;
+}
+
+bool span_reader::is_exhausted() const
+{
+    return !valid_ || position_ == end_;
+}
+
+void span_reader::invalidate()
+{
+    valid_ = false;
+    position_ = end_;
+}
+
+size_t span_reader::remaining() const
+{
+    return static_cast<size_t>(end_ - position_);
+}
+
+bool span_reader::ensure(size_t size)
+{
+    if (valid_ && size <= remaining())
+        return true;
+
+    invalidate();
+    return false;
+}
+
+template <typename Integer>
+Integer span_reader::read_little_endian()
+{
+    Integer value = 0;
+    if (!ensure(sizeof(Integer)))
+        return value;
+
+    std::memcpy(&value, position_, sizeof(Integer));
+    position_ += sizeof(Integer);
+    return boost::endian::little_to_native(value);
+}
+
+template <typename Integer>
+Integer span_reader::read_big_endian()
+{
+    Integer value = 0;
+    if (!ensure(sizeof(Integer)))
+        return value;
+
+    std::memcpy(&value, position_, sizeof(Integer));
+    position_ += sizeof(Integer);
+    return boost::endian::big_to_native(value);
+}
+
+template <size_t Size>
+byte_array<Size> span_reader::read_array()
+{
+    byte_array<Size> out{ {} };
+    if (!ensure(Size))
+        return out;
+
+    std::copy(position_, position_ + Size, out.begin());
+    position_ += Size;
+    return out;
+}
+
+// Hashes.
+// ----------------------------------------------------------------------------
+
+hash_digest span_reader::read_hash()
+{
+    return read_array<hash_size>();
+}
+
+short_hash span_reader::read_short_hash()
+{
+    return read_array<short_hash_size>();
+}
+
+mini_hash span_reader::read_mini_hash()
+{
+    return read_array<mini_hash_size>();
+}
+
+// Big endian integers.
+// ----------------------------------------------------------------------------
+
+uint16_t span_reader::read_2_bytes_big_endian()
+{
+    return read_big_endian<uint16_t>();
+}
+
+uint32_t span_reader::read_4_bytes_big_endian()
+{
+    return read_big_endian<uint32_t>();
+}
+
+uint64_t span_reader::read_8_bytes_big_endian()
+{
+    return read_big_endian<uint64_t>();
+}
+
+uint64_t span_reader::read_variable_big_endian()
+{
+    const auto value = read_byte();
+
+    switch (value)
+    {
+        case varint_eight_bytes:
+            return read_8_bytes_big_endian();
+        case varint_four_bytes:
+            return read_4_bytes_big_endian();
+        case varint_two_bytes:
+            return read_2_bytes_big_endian();
+        default:
+            return value;
+    }
+}
+
+size_t span_reader::read_size_big_endian()
+{
+    const auto size = read_variable_big_endian();
+
+    // Zero lets the caller go on before checking the reader.
+    if (size <= std::numeric_limits<size_t>::max())
+        return static_cast<size_t>(size);
+
+    invalidate();
+    return 0;
+}
+
+// Little endian integers.
+// ----------------------------------------------------------------------------
+
+code span_reader::read_error_code()
+{
+    const auto value = read_little_endian<uint32_t>();
+    return code(static_cast<error::error_code_t>(value));
+}
+
+uint16_t span_reader::read_2_bytes_little_endian()
+{
+    return read_little_endian<uint16_t>();
+}
+
+uint32_t span_reader::read_4_bytes_little_endian()
+{
+    return read_little_endian<uint32_t>();
+}
+
+uint64_t span_reader::read_8_bytes_little_endian()
+{
+    return read_little_endian<uint64_t>();
+}
+
+uint64_t span_reader::read_variable_little_endian()
+{
+    const auto value = read_byte();
+
+    switch (value)
+    {
+        case varint_eight_bytes:
+            return read_8_bytes_little_endian();
+        case varint_four_bytes:
+            return read_4_bytes_little_endian();
+        case varint_two_bytes:
+            return read_2_bytes_little_endian();
+        default:
+            return value;
+    }
+}
+
+size_t span_reader::read_size_little_endian()
+{
+    const auto size = read_variable_little_endian();
+
+    // Zero lets the caller go on before checking the reader.
+    if (size <= std::numeric_limits<size_t>::max())
+        return static_cast<size_t>(size);
+
+    invalidate();
+    return 0;
+}
+
+// Bytes and strings.
+// ----------------------------------------------------------------------------
+
+uint8_t span_reader::peek_byte()
+{
+    return ensure(1) ? *position_ : 0;
+}
+
+uint8_t span_reader::read_byte()
+{
+    return ensure(1) ? *position_++ : 0;
+}
+
+data_chunk span_reader::read_bytes()
+{
+    return read_bytes(remaining());
+}
+
+data_chunk span_reader::read_bytes(size_t size)
+{
+    if (!ensure(size))
+        return{};
+
+    const auto begin = position_;
+    position_ += size;
+    return data_chunk(begin, position_);
+}
+
+std::string span_reader::read_string()
+{
+    return read_string(read_size_little_endian());
+}
+
+std::string span_reader::read_string(size_t size)
+{
+    if (!ensure(size))
+        return{};
+
+    // Trim at the first null.
+    const auto begin = position_;
+    position_ += size;
+    return std::string(begin, std::find(begin, position_, 0));
+}
+
+void span_reader::skip(size_t size)
+{
+    if (ensure(size))
+        position_ += size;
+}
+
+} // namespace libbitcoin
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017-2018
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SPAN_READER_HPP
+#define LIBBITCOIN_SPAN_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <bitcoin/bitcoin/error.hpp>
+#include <bitcoin/bitcoin/math/hash.hpp>
+#include <bitcoin/bitcoin/utility/data.hpp>
+#include <bitcoin/bitcoin/utility/reader.hpp>
+
+namespace libbitcoin {
+
+/**
+ * Reader over a contiguous buffer, which must outlive it.
+ *
+ * Integers and hashes are loaded directly from the buffer and byte strings
+ * are copied in one piece, where istream_reader goes through the stream
+ * byte by byte. Reading past the end invalidates the reader, as a failed
+ * stream does, and further reads return zeros.
+ */
+class span_reader final
+  : public reader
+{
+public:
+    span_reader(const uint8_t* begin, const uint8_t* end);
+    explicit span_reader(const data_chunk& data);
+
+    // Context.
+    operator bool() const override;
+    bool operator!() const override;
+    bool is_exhausted() const override;
+    void invalidate() override;
+
+    // Hashes.
+    hash_digest read_hash() override;
+    short_hash read_short_hash() override;
+    mini_hash read_mini_hash() override;
+
+    // Big endian integers.
+    uint16_t read_2_bytes_big_endian() override;
+    uint32_t read_4_bytes_big_endian() override;
+    uint64_t read_8_bytes_big_endian() override;
+    uint64_t read_variable_big_endian() override;
+    size_t read_size_big_endian() override;
+
+    // Little endian integers.
+    code read_error_code() override;
+    uint16_t read_2_bytes_little_endian() override;
+    uint32_t read_4_bytes_little_endian() override;
+    uint64_t read_8_bytes_little_endian() override;
+    uint64_t read_variable_little_endian() override;
+    size_t read_size_little_endian() override;
+
+    // Bytes and strings.
+    uint8_t peek_byte() override;
+    uint8_t read_byte() override;
+    data_chunk read_bytes() override;
+    data_chunk read_bytes(size_t size) override;
+    std::string read_string() override;
+    std::string read_string(size_t size) override;
+    void skip(size_t size) override;
+
+    /// Bytes left to read.
+    size_t remaining() const;
+
+private:
+    // Invalidates the reader if fewer than size bytes are left.
+    bool ensure(size_t size);
+
+    template <typename Integer>
+    Integer read_little_endian();
+
+    template <typename Integer>
+    Integer read_big_endian();
+
+    template <size_t Size>
+    byte_array<Size> read_array();
+
+    const uint8_t* position_;
+    const uint8_t* const end_;
+    bool valid_;
+};
+
+} // namespace libbitcoin
+
+#endif